@@ -0,0 +1,182 @@
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include "control_unit.hpp"
+#include "cpu.hpp"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Saved state of a control unit, consisting of a header, the core state
+   and the memory block holding data memory and stack. The file is mapped
+   into memory once and can then be restored into any number of control
+   units running the same program image. Files whose stack pointer or
+   segment sizes do not fit the saved memory block are rejected when they
+   are opened, and a decoded instruction waiting to be executed must be the
+   instruction of the program image at the saved address. */
+struct cpu::checkpoint
+{
+   static constexpr std::uint32_t MAGIC = 0x54504B43; /* "CKPT" */
+   static constexpr std::uint32_t VERSION = 1;
+
+   struct header
+   {
+      std::uint32_t magic = MAGIC;
+      std::uint32_t version = VERSION;
+      std::uint64_t image_hash = 0;
+      std::uint32_t core_size = sizeof(core_state);
+      std::uint32_t memory_size = 0;
+      std::uint64_t interrupt_start = 0;
+      std::uint64_t worst_case_interrupt_cycles = 0;
+      std::uint64_t interrupt_depth = 0;
+   };
+
+   const std::uint8_t* mapping = nullptr;
+   std::size_t size = 0;
+
+   checkpoint(const std::string& filename)
+   {
+#ifdef __unix__
+      const auto fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) return;
+
+      struct stat file_status;
+
+      if (fstat(fd, &file_status) != 0 || static_cast<std::size_t>(file_status.st_size) < sizeof(header))
+      {
+         close(fd);
+         return;
+      }
+
+      const auto address = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (address == MAP_FAILED) return;
+
+      mapping = static_cast<const std::uint8_t*>(address);
+      size = file_status.st_size;
+
+      if (!valid())
+      {
+         munmap(const_cast<std::uint8_t*>(mapping), size);
+         mapping = nullptr;
+         size = 0;
+      }
+#endif
+      return;
+   }
+
+   ~checkpoint(void)
+   {
+#ifdef __unix__
+      if (mapping) munmap(const_cast<std::uint8_t*>(mapping), size);
+#endif
+      return;
+   }
+
+   checkpoint(const checkpoint&) = delete;
+   checkpoint& operator=(const checkpoint&) = delete;
+
+   bool is_open(void) const
+   {
+      return mapping != nullptr;
+   }
+
+   header read_header(void) const
+   {
+      header file_header;
+      std::memcpy(&file_header, mapping, sizeof(header));
+      return file_header;
+   }
+
+   core_state read_core(void) const
+   {
+      core_state core;
+      std::memcpy(static_cast<void*>(&core), mapping + sizeof(header), sizeof(core_state));
+      return core;
+   }
+
+   bool valid(void) const
+   {
+      const auto file_header = read_header();
+
+      if (file_header.magic != MAGIC || file_header.version != VERSION ||
+          file_header.core_size != sizeof(core_state) ||
+          size != sizeof(header) + sizeof(core_state) + file_header.memory_size)
+      {
+         return false;
+      }
+
+      const auto core = read_core();
+
+      return core.stack_size > 0 && core.sp < core.stack_size &&
+             static_cast<std::uint64_t>(core.data_size) + core.stack_size == file_header.memory_size &&
+             core.current_state <= state::execute;
+   }
+
+   static bool valid_pipeline(const core_state& core, const program_image& image)
+   {
+      if (core.current_state != state::execute) return true;
+      const auto instruction = image.read_decoded(core.mar);
+
+      return program_image::valid({ core.op_code, core.op1, core.op2 }) &&
+             instruction.op_code == core.op_code && instruction.op1 == core.op1 && instruction.op2 == core.op2;
+   }
+
+   bool matches(const program_image& image) const
+   {
+      return is_open() && read_header().image_hash == image.hash() && valid_pipeline(read_core(), image);
+   }
+
+   template<class debug_policy, class heatmap_policy>
+   static int save(const control_unit<debug_policy, heatmap_policy>& unit,
+                   const std::string& filename)
+   {
+      std::ofstream file(filename, std::ios::binary);
+      if (!file) return 1;
+
+      header file_header;
+      file_header.image_hash = unit.prog_mem.image->hash();
+      file_header.memory_size = static_cast<std::uint32_t>(unit.memory.size());
+      file_header.interrupt_start = unit.interrupt_start;
+      file_header.worst_case_interrupt_cycles = unit.worst_case_interrupt_cycles;
+      file_header.interrupt_depth = unit.interrupt_depth;
+
+      auto core = unit.core;
+      core.program = nullptr;
+      core.memory = nullptr;
+
+      file.write(reinterpret_cast<const char*>(&file_header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(&core), sizeof(core_state));
+      file.write(reinterpret_cast<const char*>(unit.memory.data()), unit.memory.size());
+      return file ? 0 : 1;
+   }
+
+   template<class debug_policy, class heatmap_policy>
+   int restore(control_unit<debug_policy, heatmap_policy>& unit) const
+   {
+      if (!matches(*unit.prog_mem.image)) return 1;
+      const auto file_header = read_header();
+
+      const auto program = unit.core.program;
+      const auto program_size = unit.core.program_size;
+
+      unit.core = read_core();
+      unit.memory.resize(file_header.memory_size);
+      std::memcpy(unit.memory.data(), mapping + sizeof(header) + sizeof(core_state), file_header.memory_size);
+
+      unit.core.program = program;
+      unit.core.program_size = program_size;
+      unit.core.memory = unit.memory.data();
+
+      unit.interrupt_start = file_header.interrupt_start;
+      unit.worst_case_interrupt_cycles = file_header.worst_case_interrupt_cycles;
+      unit.interrupt_depth = static_cast<std::size_t>(file_header.interrupt_depth);
+      return 0;
+   }
+};
+
+#endif /* CHECKPOINT_HPP_ */
\ No newline at end of file
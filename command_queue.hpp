@@ -0,0 +1,55 @@
+#ifndef COMMAND_QUEUE_HPP_
+#define COMMAND_QUEUE_HPP_
+
+#include "cpu.hpp"
+
+/* Single producer, single consumer ring buffer. One slot is kept empty
+   to tell a full queue from an empty one, so at most N - 1 elements fit. */
+template<class T, std::size_t N>
+struct cpu::command_queue
+{
+   std::array<T, N> data{};
+   alignas(64) std::atomic<std::size_t> head{0};
+   alignas(64) std::atomic<std::size_t> tail{0};
+
+   static constexpr std::size_t next(const std::size_t index)
+   {
+      return (index + 1) % N;
+   }
+
+   bool push(const T& new_element)
+   {
+      const auto current_tail = tail.load(std::memory_order_relaxed);
+      const auto next_tail = next(current_tail);
+
+      if (next_tail == head.load(std::memory_order_acquire))
+      {
+         return false;
+      }
+
+      data[current_tail] = new_element;
+      tail.store(next_tail, std::memory_order_release);
+      return true;
+   }
+
+   bool pop(T& retrieved_value)
+   {
+      const auto current_head = head.load(std::memory_order_relaxed);
+
+      if (current_head == tail.load(std::memory_order_acquire))
+      {
+         return false;
+      }
+
+      retrieved_value = data[current_head];
+      head.store(next(current_head), std::memory_order_release);
+      return true;
+   }
+
+   bool empty(void) const
+   {
+      return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+   }
+};
+
+#endif /* COMMAND_QUEUE_HPP_ */
\ No newline at end of file
@@ -4,8 +4,14 @@
 #include "program_memory.hpp"
 #include "data_memory.hpp"
 #include "stack.hpp"
+#include "debugger.hpp"
+#include "heatmap.hpp"
+#include "core_state.hpp"
+#include "interrupt_controller.hpp"
+#include "snapshot.hpp"
 #include "cpu.hpp"
 
+template<class debug_policy, class heatmap_policy>
 struct cpu::control_unit
 {
    static constexpr auto I = 4;
@@ -17,67 +23,117 @@ struct cpu::control_unit
    static constexpr auto NUM_REGISTERS = 32;
    static constexpr auto DATA_WIDTH = 8;
 
+   static constexpr auto INTERRUPT_LATENCY = 4;
+   static constexpr auto CLOCK_FREQUENCY = 16000000.0;
+
+   core_state core;
    program_memory prog_mem;
-   data_memory<std::uint8_t> data_mem;
-   stack<std::uint8_t> stack;
-   std::array<std::uint8_t, NUM_REGISTERS> reg{};
+   std::vector<std::uint8_t> memory;
 
-   std::uint8_t pc = 0x00;
-   std::uint8_t mar = 0x00;
-   std::uint32_t ir = 0x00;
-   std::uint8_t sr = 0x00;
+   std::uint64_t interrupt_start = 0;
+   std::uint64_t worst_case_interrupt_cycles = 0;
+   std::size_t interrupt_depth = 0;
 
-   std::uint8_t op_code = 0x00;
-   std::uint8_t op1 = 0x00;
-   std::uint8_t op2 = 0x00;
+   [[no_unique_address]] debug_policy debug;
+   [[no_unique_address]] heatmap_policy usage;
 
-   state current_state = state::fetch;
-   std::uint8_t last_input = 0x00;
+   control_unit(std::shared_ptr<const program_image> image = program_memory::demo_image(),
+                const std::size_t data_memory_size = 2000,
+                const std::size_t stack_size = 256)
+      : prog_mem{std::move(image)}
+      , memory(data_memory_size + stack_size, 0x00)
+   {
+      core.program = prog_mem.image->decoded.data();
+      core.program_size = static_cast<std::uint32_t>(prog_mem.address_width());
+      core.data_size = static_cast<std::uint32_t>(data_memory_size);
+      core.stack_size = static_cast<std::uint32_t>(stack_size);
+      core.sp = core.stack_size - 1;
+      core.memory = memory.data();
+      return;
+   }
 
-   control_unit(void) 
+   control_unit(const control_unit& source)
+      : core{source.core}
+      , prog_mem{source.prog_mem}
+      , memory{source.memory}
+      , interrupt_start{source.interrupt_start}
+      , worst_case_interrupt_cycles{source.worst_case_interrupt_cycles}
+      , interrupt_depth{source.interrupt_depth}
+      , debug{source.debug}
+      , usage{source.usage}
    {
-      data_mem.init(2000);
-      stack.init(256);
+      core.memory = memory.data();
       return;
    }
 
-   void reset(void)
+   control_unit& operator=(const control_unit& source)
    {
-      data_mem.reset();
-      stack.reset();
-      pc = 0x00;
-      mar = 0x00;
-      ir = 0x00;
-      sr = 0x00;
+      core = source.core;
+      prog_mem = source.prog_mem;
+      memory = source.memory;
+      interrupt_start = source.interrupt_start;
+      worst_case_interrupt_cycles = source.worst_case_interrupt_cycles;
+      interrupt_depth = source.interrupt_depth;
+      debug = source.debug;
+      usage = source.usage;
+      core.memory = memory.data();
+      return *this;
+   }
 
-      op_code = 0x00;
-      op1 = 0x00;
-      op2 = 0x00;
+   control_unit(control_unit&&) = default;
+   control_unit& operator=(control_unit&&) = default;
 
-      current_state = state::fetch;
-      last_input = 0x00;
+   data_memory<std::uint8_t> data_mem(void)
+   {
+      return { core.memory, core.data_size };
+   }
 
-      for (auto& i : reg)
-      {
-         i = 0x00;
-      }
+   data_memory<const std::uint8_t> data_mem(void) const
+   {
+      return { core.memory, core.data_size };
+   }
+
+   cpu::stack<std::uint8_t> stack(void)
+   {
+      return { core.memory + core.data_size, core.stack_size, core.sp, core.stack_empty };
+   }
 
+   void reset(void)
+   {
+      const auto program = core.program;
+      const auto program_size = core.program_size;
+      const auto data_size = core.data_size;
+      const auto stack_size = core.stack_size;
+
+      core = core_state{};
+      core.program = program;
+      core.program_size = program_size;
+      core.data_size = data_size;
+      core.stack_size = stack_size;
+      core.memory = memory.data();
+
+      data_mem().reset();
+      stack().reset();
+
+      interrupt_start = 0;
+      worst_case_interrupt_cycles = 0;
+      interrupt_depth = 0;
       return;
    }
 
    bool interrupt_enabled(void) const
    {
-      return read(sr, I);
+      return read(core.sr, I);
    }
 
    bool negative(void) const
    {
-      return read(sr, N);
+      return read(core.sr, N);
    }
 
    bool equal(void) const
    {
-      return read(sr, Z);
+      return read(core.sr, Z);
    }
 
    bool greater(void) const
@@ -90,29 +146,100 @@ struct cpu::control_unit
       return negative();
    }
 
+   bool halted(void) const
+   {
+      if constexpr (debug_policy::enabled) return debug.halted;
+      else return false;
+   }
+
+   std::uint8_t read_data(const std::size_t address)
+   {
+      const auto value = data_mem().read(address);
+      if constexpr (debug_policy::enabled) debug.on_read(address, value);
+      if constexpr (heatmap_policy::enabled) usage.on_read(address);
+      return value;
+   }
+
+   void write_data(const std::size_t address, const std::uint8_t value)
+   {
+      if constexpr (debug_policy::enabled) debug.on_write(address, data_mem().read(address), value);
+      if constexpr (heatmap_policy::enabled) usage.on_write(address);
+      data_mem().write(address, value);
+      return;
+   }
+
+   std::size_t stack_usage(void) const
+   {
+      return core.stack_empty ? 0 : core.stack_size - core.sp;
+   }
+
+   program_image::instruction read_program(const std::uint8_t address) const
+   {
+      return address < core.program_size ? core.program[address] : program_image::instruction{};
+   }
+
+   std::uint8_t next_op_code(void) const
+   {
+      if (core.current_state == state::fetch) return read_program(core.pc).op_code;
+      else if (core.current_state == state::decode) return read_program(core.mar).op_code;
+      else return core.op_code;
+   }
+
+   bool branch(const bool condition)
+   {
+      if (condition) core.pc = core.op1;
+      return condition;
+   }
+
+   std::uint64_t cycle_count(void) const
+   {
+      return core.cycles;
+   }
+
+   double elapsed_time(const double clock_frequency = CLOCK_FREQUENCY) const
+   {
+      return core.cycles / clock_frequency;
+   }
+
+   double worst_case_interrupt_time(const double clock_frequency = CLOCK_FREQUENCY) const
+   {
+      return worst_case_interrupt_cycles / clock_frequency;
+   }
+
    void generate_interrupt(const std::uint8_t interrupt_vector)
    {
-      stack.push(pc);
-      stack.push(mar);
-      stack.push(sr);
+      [[maybe_unused]] const auto previous_stack_usage = stack_usage();
+      stack().push(core.pc);
+      stack().push(core.mar);
+      stack().push(core.sr);
 
-      stack.push(ir >> 16);
-      stack.push(ir >> 8);
-      stack.push(ir);
+      stack().push(core.ir >> 16);
+      stack().push(core.ir >> 8);
+      stack().push(core.ir);
 
-      stack.push(op_code);
-      stack.push(op1);
-      stack.push(op2);
+      stack().push(core.op_code);
+      stack().push(core.op1);
+      stack().push(core.op2);
 
-      stack.push(static_cast<std::uint8_t>(current_state));
+      stack().push(static_cast<std::uint8_t>(core.current_state));
      
-      for (auto& i : reg)
+      for (auto& i : core.reg)
+      {
+         stack().push(i);
+      }
+
+      core.pc = interrupt_vector;
+      core.current_state = state::fetch;
+      clr(core.sr, I);
+
+      if constexpr (heatmap_policy::enabled)
       {
-         stack.push(i);
+         usage.on_stack_change(stack_source::interrupt, previous_stack_usage, stack_usage());
       }
 
-      pc = interrupt_vector;
-      current_state = state::fetch;
+      if (interrupt_depth++ == 0) interrupt_start = core.cycles;
+      core.cycles += INTERRUPT_LATENCY;
+      core.num_interrupts++;
       return;
    }
 
@@ -120,53 +247,46 @@ struct cpu::control_unit
    {
       std::uint8_t temp = 0x00;
 
-      for (auto& i : reg)
+      for (auto& i : core.reg)
       {
-         stack.pop(i);
+         stack().pop(i);
       }
 
-      stack.pop(temp);
-      current_state = static_cast<state>(temp);
+      stack().pop(temp);
+      core.current_state = static_cast<state>(temp);
+
+      stack().pop(core.op2);
+      stack().pop(core.op1);
+      stack().pop(core.op_code);
 
-      stack.pop(op2);
-      stack.pop(op1);
-      stack.pop(op_code);
+      stack().pop(temp);
+      core.ir = temp;
+      stack().pop(temp);
+      core.ir |= temp << 8;
+      stack().pop(temp);
+      core.ir |= temp << 16;
 
-      stack.pop(temp);
-      ir = temp;
-      stack.pop(temp);
-      ir |= temp << 8;
-      stack.pop(temp);
-      ir |= temp << 16;
+      stack().pop(core.sr);
+      stack().pop(core.mar);
+      stack().pop(core.pc);
 
-      stack.pop(sr);
-      stack.pop(mar);
-      stack.pop(pc);
+      if (interrupt_depth > 0 && --interrupt_depth == 0)
+      {
+         const auto interrupt_cycles = core.cycles + cycle_cost(RETI) - interrupt_start;
+         if (interrupt_cycles > worst_case_interrupt_cycles) worst_case_interrupt_cycles = interrupt_cycles;
+      }
       return;
    }
 
    void monitor_interrupts(void)
    {
-      const auto current_input = data_mem.read(PINB);
+      const auto io = data_mem();
+      interrupt_controller::sample_pin_changes(core, io.read(PINB), io.read(PCICR), io.read(PCMSK0));
 
-      if (interrupt_enabled())
+      if (core.pending && interrupt_enabled())
       {
-         if (data_mem.read(PCICR) & (1 << PCIE0))
-         {
-            for (auto i = 0; i < DATA_WIDTH; ++i)
-            {
-               if (data_mem.read(PCMSK0) & (1 << i))
-               {
-                  if (read(last_input, i) != read(current_input, i))
-                  {
-                     generate_interrupt(prog_mem.PCINT0_vect);
-                  }
-               }
-            }
-         }
+         generate_interrupt(interrupt_controller::acknowledge(core));
       }
-
-      last_input = current_input;
       return;
    }
 
@@ -197,16 +317,16 @@ struct cpu::control_unit
    {
       std::uint16_t result = 0x00;
 
-      if (op_code == ORI || op_code == OR) result = a | b;
-      else if (op_code == ANDI || op_code == AND) result = a & b;
-      else if (op_code == XORI || op_code == XOR) result = a ^ b;
-      else if (op_code == INC) result = a + 1;
-      else if (op_code == DEC) result = a - 1;
-      else if (op_code == ADDI || op_code == ADD) result = a + b;
-      else if (op_code == SUBI || op_code == SUB) result = a - b;
-      else if (op_code == CPI || op_code == CP) result = a - b;
+      if (core.op_code == ORI || core.op_code == OR) result = a | b;
+      else if (core.op_code == ANDI || core.op_code == AND) result = a & b;
+      else if (core.op_code == XORI || core.op_code == XOR) result = a ^ b;
+      else if (core.op_code == INC) result = a + 1;
+      else if (core.op_code == DEC) result = a - 1;
+      else if (core.op_code == ADDI || core.op_code == ADD) result = a + b;
+      else if (core.op_code == SUBI || core.op_code == SUB) result = a - b;
+      else if (core.op_code == CPI || core.op_code == CP) result = a - b;
 
-      sr |= get_status_bits(result, a, b);
+      core.sr |= get_status_bits(result, a, b);
       return static_cast<std::uint8_t>(result);
    }
 
@@ -214,152 +334,175 @@ struct cpu::control_unit
                 const std::uint8_t b)
    {
       const std::uint16_t result = a - b;
-      sr = get_status_bits(result, a, b);
+      core.sr = get_status_bits(result, a, b);
       return;
    }
 
    void run_next_state(void)
    {
-      switch (current_state)
+      switch (core.current_state)
       {
          case state::fetch:
          {
-            ir = prog_mem.read(pc);
-            mar = pc;
-            pc++;
-            current_state = state::decode;
+            if constexpr (debug_policy::enabled)
+            {
+               if (debug.check_breakpoint(core.pc)) return;
+            }
+
+            const auto instruction = read_program(core.pc);
+            core.ir = program_memory::assemble(instruction.op_code, instruction.op1, instruction.op2);
+            core.mar = core.pc;
+            core.pc++;
+            core.current_state = state::decode;
             break;
          }
          case state::decode:
          {
-            op_code = ir >> 16;
-            op1 = ir >> 8;
-            op2 = ir;
-            current_state = state::execute;
+            const auto instruction = read_program(core.mar);
+            core.op_code = instruction.op_code;
+            core.op1 = instruction.op1;
+            core.op2 = instruction.op2;
+            core.current_state = state::execute;
             break;
          }
          case state::execute:
          {
-            if (op_code == LDI)
+            const auto instruction = core.op_code;
+            auto taken = false;
+            core.current_state = state::fetch;
+            [[maybe_unused]] std::array<std::uint8_t, NUM_REGISTERS> previous_reg;
+            [[maybe_unused]] std::size_t previous_stack_usage = 0;
+            if constexpr (debug_policy::enabled) previous_reg = core.reg;
+            if constexpr (heatmap_policy::enabled) previous_stack_usage = stack_usage();
+
+            if (core.op_code == LDI)
             {
-               reg[op1] = op2;
+               core.reg[core.op1] = core.op2;
             }
-            else if (op_code == MOV)
+            else if (core.op_code == MOV)
             {
-               reg[op1] = reg[op2];
+               core.reg[core.op1] = core.reg[core.op2];
             }
-            else if (op_code == OUT)
+            else if (core.op_code == OUT)
             {
-               data_mem.write(op1, reg[op2]);
+               write_data(core.op1, core.reg[core.op2]);
             }
-            else if (op_code == IN)
+            else if (core.op_code == IN)
             {
-               reg[op1] = data_mem.read(op2);
+               core.reg[core.op1] = read_data(core.op2);
             }
-            else if (op_code == STS)
+            else if (core.op_code == STS)
             {
-               data_mem.write(static_cast<std::size_t>(op1), reg[op2]);
+               write_data(static_cast<std::size_t>(core.op1), core.reg[core.op2]);
 
-               if (op2 < NUM_REGISTERS)
+               if (core.op2 < NUM_REGISTERS)
                {
-                  data_mem.write(static_cast<std::size_t>(op1) + 1, reg[static_cast<std::uint8_t>(op2 + 1)]);
+                  write_data(static_cast<std::size_t>(core.op1) + 1, core.reg[static_cast<std::uint8_t>(core.op2 + 1)]);
                }
             }
-            else if (op_code == LDS)
+            else if (core.op_code == LDS)
             {
-               reg[op1] = data_mem.read(op2);
+               core.reg[core.op1] = read_data(core.op2);
 
-               if (op1 < NUM_REGISTERS)
+               if (core.op1 < NUM_REGISTERS)
                {
-                  reg[static_cast<std::uint8_t>(op1 + 1)] = data_mem.read(static_cast<std::size_t>(op2 + 1));
+                  core.reg[static_cast<std::uint8_t>(core.op1 + 1)] = read_data(static_cast<std::size_t>(core.op2 + 1));
                }
             }
-            else if (op_code == ORI || op_code == ANDI || op_code == XORI)
+            else if (core.op_code == ORI || core.op_code == ANDI || core.op_code == XORI)
             {
-               reg[op1] = alu(reg[op1], op2);
+               core.reg[core.op1] = alu(core.reg[core.op1], core.op2);
             }
-            else if (op_code == OR || op_code == AND || op_code == XOR)
+            else if (core.op_code == OR || core.op_code == AND || core.op_code == XOR)
             {
-               reg[op1] = alu(reg[op1], reg[op2]);
+               core.reg[core.op1] = alu(core.reg[core.op1], core.reg[core.op2]);
             }
-            else if (op_code == CLR)
+            else if (core.op_code == CLR)
             {
-               reg[op1] = 0x00;
+               core.reg[core.op1] = 0x00;
             }
-            else if (op_code == INC || op_code == DEC)
+            else if (core.op_code == INC || core.op_code == DEC)
             {
-               reg[op1] = alu(reg[op1]);
+               core.reg[core.op1] = alu(core.reg[core.op1]);
             }
-            else if (op_code == CPI)
+            else if (core.op_code == CPI)
             {
-               compare(reg[op1], op2);
+               compare(core.reg[core.op1], core.op2);
             }
-            else if (op_code == CP)
+            else if (core.op_code == CP)
             {
-               compare(reg[op1], reg[op2]);
+               compare(core.reg[core.op1], core.reg[core.op2]);
             }
-            else if (op_code == JMP)
+            else if (core.op_code == JMP)
             {
-               pc = op1;
+               core.pc = core.op1;
             }
-            else if (op_code == BREQ)
+            else if (core.op_code == BREQ)
             {
-               if (equal()) pc = op1;
+               taken = branch(equal());
             }
-            else if (op_code == BRNE)
+            else if (core.op_code == BRNE)
             {
-               if (!equal())
-               {
-                  pc = op1;
-               }
+               taken = branch(!equal());
             }
-            else if (op_code == BRGE)
+            else if (core.op_code == BRGE)
             {
-               if (greater() || equal()) pc = op1;
+               taken = branch(greater() || equal());
             }
-            else if (op_code == BRGT)
+            else if (core.op_code == BRGT)
             {
-               if (greater()) pc = op1;
+               taken = branch(greater());
             }
-            else if (op_code == BRLE)
+            else if (core.op_code == BRLE)
             {
-               if (lower() || equal()) pc = op1;
+               taken = branch(lower() || equal());
             }
-            else if (op_code == BRLT)
+            else if (core.op_code == BRLT)
             {
-               if (lower()) pc = op1;
+               taken = branch(lower());
             }
-            else if (op_code == CALL)
+            else if (core.op_code == CALL)
             {
-               stack.push(pc);
-               pc = op1;
+               stack().push(core.pc);
+               core.pc = core.op1;
             }
-            else if (op_code == RET)
+            else if (core.op_code == RET)
             {
-               stack.pop(pc);
+               stack().pop(core.pc);
             }
-            else if (op_code == PUSH)
+            else if (core.op_code == PUSH)
             {
-               stack.push(reg[op1]);
+               stack().push(core.reg[core.op1]);
             }
-            else if (op_code == POP)
+            else if (core.op_code == POP)
             {
-               stack.pop(reg[op1]);
+               stack().pop(core.reg[core.op1]);
             }
-            else if (op_code == SEI)
+            else if (core.op_code == SEI)
             {
-               set(sr, I);
+               set(core.sr, I);
             }
-            else if (op_code == CLI)
+            else if (core.op_code == CLI)
             {
-               clr(sr, I);
+               clr(core.sr, I);
             }
-            else if (op_code == RETI)
+            else if (core.op_code == RETI)
             {
                return_from_interrupt();
             }
 
-            current_state = state::fetch;
+            if constexpr (debug_policy::enabled)
+            {
+               debug.on_register_change(previous_reg, core.reg);
+            }
+
+            if constexpr (heatmap_policy::enabled)
+            {
+               usage.on_stack_change(heatmap::stack_source_of(instruction), previous_stack_usage, stack_usage());
+            }
+
+            core.cycles += cycle_cost(instruction, taken);
+            core.num_instructions++;
             break;
          }
          default:
@@ -369,130 +512,56 @@ struct cpu::control_unit
          }
       }
 
-      monitor_interrupts();
-      return;
-   }
-
-   void print(std::ostream& ostream = std::cout) const
-   {
-      ostream << "--------------------------------------------------------------------------------\n";
-      ostream << "Subroutine:\t\t\t\t\t" << prog_mem.subroutine_name(mar) << "\n";
-      ostream << "Current instruction:\t\t\t\t" << cpu::instruction_name(op_code) << "\n";
-      ostream << "Current state:\t\t\t\t\t" << cpu::state_name(current_state) << "\n\n";
-
-      ostream << "Program counter:\t\t\t\t" << static_cast<int>(pc) << "\n";
-      ostream << "Instruction register:\t\t\t\t" << std::hex << static_cast<int>(ir) << "\n";
-      ostream << "Status register (INZVC):\t\t\t" << std::bitset<5>(sr) << "\n\n";
-
-      ostream << "Content in CPU register R16:\t\t\t" << std::bitset<8>(reg[R16]) << "\n";
-      ostream << "Content in CPU register R24:\t\t\t" << std::bitset<8>(reg[R24]) << "\n\n";
-
-      ostream << "Content in data direction register DDRB:\t" << std::bitset<8>(data_mem.read(DDRB)) << "\n";
-      ostream << "Content in data register PORTB:\t\t\t" << std::bitset<8>(data_mem.read(PORTB)) << "\n";
-      ostream << "Content in pin register PINB:\t\t\t" << std::bitset<8>(data_mem.read(PINB)) << "\n";
-      ostream << "--------------------------------------------------------------------------------\n\n";
-   }
-
-   static void readline(std::string& s)
-   {
-      std::getline(std::cin, s);
-      std::cout << "\n";
+      if (core.current_state == state::fetch) monitor_interrupts();
       return;
    }
 
-   template<class T = int>
-   static T convert(const std::string& s)
+   void run_next_instruction(void)
    {
-      T val{};
-
-      std::stringstream stream(s);
-      stream >> val;
-      return val;
-   }
-
-   template<class T = int>
-   static T get_input(void)
-   {
-      std::string s;
-      readline(s);
-      return convert<T>(s);
-   }
+      if (core.current_state == state::execute && !halted())
+      {
+         run_next_state();
+      }
 
-   void print_menu(void) const
-   {
-      std::cout << "Please select an alternative:\n";
-      std::cout << "1. Execute next instruction cycle\n";
-      std::cout << "2. Execute next state\n";
-      std::cout << "3. System reset\n";
-      std::cout << "4. Enter input to the PINB register\n\n";
+      while (core.current_state != state::execute && !halted())
+      {
+         run_next_state();
+      }
       return;
    }
 
-   int get_selection(void) const
+   bool waiting_for_input(void) const
    {
-      print_menu();
-
-      while (1)
-      {
-         const auto selection = get_input();
-
-         if (selection >= 1 && selection <= 4)
-         {
-            return selection;
-         }
-         else
-         {
-            std::cout << "Invalid input, try again!\n\n";
-         }
-      }
+      return core.current_state == state::fetch && core.op_code == JMP && core.op1 == core.mar && core.pc == core.mar;
    }
 
-   void execute_selection(void)
+   void step(void)
    {
-      const auto selection = get_selection();
-
-      if (selection == 1)
-      {
-         std::cout << "Executing next instruction cycle!\n\n";
-
-         if (current_state == state::execute)
-         {
-            run_next_state();
-         }
-
-         while (current_state != state::execute)
-         {
-            run_next_state();
-         }
-      }
-      if (selection == 2)
+      do
       {
-         std::cout << "Executing next state!\n\n";
          run_next_state();
-      }
-      else if (selection == 3)
-      {
-         reset();
-         std::cout << "System reset!\n\n";
-      }
-      else if (selection == 4)
-      {
-         std::cout << "Enter new input for the PINB register:\n";
-         const auto input = get_input();
-         data_mem.write(PINB, input);
-         std::cout << "Wrote data " << std::bitset<8>(input) << " to register PINB!\n\n";
-      }
+      } while (core.current_state != state::fetch && !halted());
       return;
    }
 
-   void run_with_key_press(void)
+   state_snapshot snapshot(void) const
    {
-      while (1)
-      {
-         print();        
-         execute_selection();
-      }
-      return;
+      state_snapshot snapshot;
+      snapshot.num_instructions = core.num_instructions;
+      snapshot.num_interrupts = core.num_interrupts;
+      snapshot.cycles = core.cycles;
+
+      snapshot.pc = core.pc;
+      snapshot.sr = core.sr;
+      snapshot.r16 = core.reg[R16];
+      snapshot.r24 = core.reg[R24];
+
+      snapshot.ddrb = data_mem().read(DDRB);
+      snapshot.portb = data_mem().read(PORTB);
+      snapshot.pinb = data_mem().read(PINB);
+
+      std::strncpy(snapshot.subroutine, prog_mem.subroutine_name(core.mar), sizeof(snapshot.subroutine) - 1);
+      return snapshot;
    }
 };
 
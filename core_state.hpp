@@ -0,0 +1,45 @@
+#ifndef CORE_STATE_HPP_
+#define CORE_STATE_HPP_
+
+#include "program_image.hpp"
+#include "cpu.hpp"
+
+/* Hot interpreter state of a control unit, aligned to a cache line so that
+   control units packed in arrays never share lines. The first line holds
+   the register file, the program counter, the status register and the
+   pipeline, the second line the pointers and counters used on every step.
+   Data memory and stack are reached through the single memory base pointer:
+   the data memory segment starts at offset 0, followed by the stack. */
+struct alignas(64) cpu::core_state
+{
+   std::array<std::uint8_t, 32> reg{};
+   std::uint32_t ir = 0x00;
+
+   std::uint8_t pc = 0x00;
+   std::uint8_t mar = 0x00;
+   std::uint8_t sr = 0x00;
+   std::uint8_t op_code = 0x00;
+   std::uint8_t op1 = 0x00;
+   std::uint8_t op2 = 0x00;
+
+   state current_state = state::fetch;
+   std::uint8_t last_input = 0x00;
+   bool stack_empty = true;
+   std::uint8_t pending = 0x00;
+   std::uint32_t sp = 0;
+   std::uint8_t* memory = nullptr;
+
+   const program_image::instruction* program = nullptr;
+   std::uint32_t program_size = 0;
+   std::uint32_t data_size = 0;
+   std::uint32_t stack_size = 0;
+
+   std::uint64_t cycles = 0;
+   std::uint64_t num_instructions = 0;
+   std::uint64_t num_interrupts = 0;
+};
+
+static_assert(offsetof(cpu::core_state, program) == 64, "the first cache line of core_state is full");
+static_assert(sizeof(cpu::core_state) == 128, "core_state spans two cache lines");
+
+#endif /* CORE_STATE_HPP_ */
\ No newline at end of file
@@ -8,6 +8,26 @@
 #include <string>
 #include <bitset>
 #include <sstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <iomanip>
+#include <coroutine>
+#include <deque>
+#include <utility>
+#include <cstring>
+#include <type_traits>
+#include <cstddef>
+#include <bit>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <iterator>
+#include <cctype>
+#include <algorithm>
+#include <limits>
 
 namespace cpu
 {
@@ -92,13 +112,57 @@ namespace cpu
    static constexpr auto R30 = 0x1E;
    static constexpr auto R31 = 0x1F;
 
-   enum class state
+   enum class state : std::uint8_t
    {
       fetch,
       decode,
       execute
    };
 
+   enum class opcode_class
+   {
+      transfer,
+      io,
+      memory,
+      alu,
+      branch,
+      subroutine,
+      control
+   };
+
+   static constexpr auto NUM_OPCODE_CLASSES = 7;
+
+   enum class stack_source
+   {
+      interrupt,
+      call,
+      push
+   };
+
+   static constexpr auto NUM_STACK_SOURCES = 3;
+
+   enum class engine
+   {
+      interpreter,
+      native,
+      specialized
+   };
+
+   enum class command_type
+   {
+      pinb,
+      reset,
+      pause,
+      resume,
+      quit
+   };
+
+   struct command
+   {
+      command_type type = command_type::pause;
+      std::uint8_t value = 0x00;
+   };
+
    template<class T = std::uint8_t>
    static inline void set(T& reg, const std::uint8_t bit)
    {
@@ -160,6 +224,68 @@ namespace cpu
       else return "Unknown";
    }
 
+   static std::uint8_t cycle_cost(const std::uint8_t instruction,
+                                  const bool branch_taken = false)
+   {
+      if (instruction == STS || instruction == LDS) return 2;
+      else if (instruction == PUSH || instruction == POP) return 2;
+      else if (instruction == JMP) return 3;
+      else if (instruction == CALL) return 4;
+      else if (instruction == RET || instruction == RETI) return 4;
+      else if (instruction >= BREQ && instruction <= BRLE) return branch_taken ? 2 : 1;
+      else return 1;
+   }
+
+   static enum opcode_class classify(const std::uint8_t instruction)
+   {
+      if (instruction == LDI || instruction == MOV || instruction == CLR) return opcode_class::transfer;
+      else if (instruction == IN || instruction == OUT) return opcode_class::io;
+      else if (instruction == STS || instruction == LDS) return opcode_class::memory;
+      else if (instruction >= ORI && instruction <= CP && instruction != CLR) return opcode_class::alu;
+      else if (instruction == JMP || (instruction >= BREQ && instruction <= BRLE)) return opcode_class::branch;
+      else if (instruction == CALL || instruction == RET || instruction == RETI) return opcode_class::subroutine;
+      else if (instruction == PUSH || instruction == POP) return opcode_class::subroutine;
+      else return opcode_class::control;
+   }
+
+   static const char* opcode_class_name(const enum opcode_class opcode_class)
+   {
+      if (opcode_class == opcode_class::transfer) return "Transfer (LDI, MOV, CLR)";
+      else if (opcode_class == opcode_class::io) return "I/O (IN, OUT)";
+      else if (opcode_class == opcode_class::memory) return "Memory (STS, LDS)";
+      else if (opcode_class == opcode_class::alu) return "ALU";
+      else if (opcode_class == opcode_class::branch) return "Branch (JMP, BRxx)";
+      else if (opcode_class == opcode_class::subroutine) return "Subroutine and stack";
+      else if (opcode_class == opcode_class::control) return "Control (NOP, SEI, CLI)";
+      else return "Unknown";
+   }
+
+   static const char* stack_source_name(const stack_source source)
+   {
+      if (source == stack_source::interrupt) return "interrupt";
+      else if (source == stack_source::call) return "CALL/RET";
+      else if (source == stack_source::push) return "PUSH/POP";
+      else return "Unknown";
+   }
+
+   static const char* engine_name(const engine engine)
+   {
+      if (engine == engine::interpreter) return "interpreter";
+      else if (engine == engine::native) return "native";
+      else if (engine == engine::specialized) return "specialized";
+      else return "Unknown";
+   }
+
+   template<class T = int>
+   static T convert(const std::string& s)
+   {
+      T val{};
+
+      std::stringstream stream(s);
+      stream >> val;
+      return val;
+   }
+
    static const char* state_name(const enum state state)
    {
       if (state == state::fetch) return "Fetch";
@@ -168,19 +294,76 @@ namespace cpu
       else return "Unknown";
    }
 
+   struct no_debug;
+   struct debugger;
+   struct no_heatmap;
+   struct heatmap;
+
+   struct core_state;
+   struct interrupt_controller;
+
+   template<class debug_policy = no_debug, class heatmap_policy = no_heatmap>
    struct control_unit;
+
+   template<class debug_policy = no_debug, class heatmap_policy = no_heatmap>
+   struct terminal;
+
+   struct program_image;
    struct program_memory;
+   struct optimizer;
+   struct perf_counters;
+   struct perf_report;
+   struct task;
+   struct scheduler;
+   struct fleet;
+   struct state_snapshot;
+   struct shared_snapshot;
+   struct fingerprint_set;
+   struct explorer;
+   struct checkpoint;
+   struct recompiler;
+   struct engine_check;
+   struct profile;
+
+   template<class control_unit_type = control_unit<>>
+   struct specialized_engine;
+
+   template<class T>
+   struct seqlock;
 
    template<class T = std::uint8_t>
    struct data_memory;
 
    template<class T = std::uint8_t>
    struct stack;
+
+   template<class T = command, std::size_t N = 64>
+   struct command_queue;
 }
 
+#include "program_image.hpp"
 #include "program_memory.hpp"
 #include "data_memory.hpp"
+#include "core_state.hpp"
+#include "interrupt_controller.hpp"
 #include "control_unit.hpp"
+#include "terminal.hpp"
 #include "stack.hpp"
+#include "command_queue.hpp"
+#include "debugger.hpp"
+#include "heatmap.hpp"
+#include "perf_counters.hpp"
+#include "scheduler.hpp"
+#include "fleet.hpp"
+#include "seqlock.hpp"
+#include "snapshot.hpp"
+#include "explorer.hpp"
+#include "checkpoint.hpp"
+#include "recompiler.hpp"
+#include "demo_native.hpp"
+#include "engine_check.hpp"
+#include "profile.hpp"
+#include "specialized_engine.hpp"
+#include "optimizer.hpp"
 
 #endif /* CPU_HPP_ */
\ No newline at end of file
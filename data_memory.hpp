@@ -3,35 +3,29 @@
 
 #include "cpu.hpp"
 
+/* View of the data memory segment in the memory block of a control unit. */
 template<class T>
 struct cpu::data_memory
 {
-   std::vector<T> data;
+   T* data = nullptr;
+   std::size_t size = 0;
 
    data_memory(void) { }
 
-   data_memory(const std::size_t address_width)
-   {
-      init(address_width);
-      return;
-   }
+   data_memory(T* data, const std::size_t address_width)
+      : data{data}
+      , size{address_width} { }
 
    std::size_t address_width(void) const
    {
-      return data.size();
-   }
-
-   void init(const std::size_t address_width = 2000)
-   {
-      data.resize(address_width, 0x00);
-      return;
+      return size;
    }
 
    void reset(void)
    {
-      for (auto& i : data)
+      for (std::size_t i = 0; i < size; ++i)
       {
-         i = 0x00;
+         data[i] = 0x00;
       }
       return;
    }
@@ -0,0 +1,177 @@
+#ifndef DEBUGGER_HPP_
+#define DEBUGGER_HPP_
+
+#include "cpu.hpp"
+
+/* Debug policies for the control unit. With no_debug, every hook is
+   removed at compile time, so production builds only contain the fast path. */
+struct cpu::no_debug
+{
+   static constexpr bool enabled = false;
+};
+
+struct cpu::debugger
+{
+   static constexpr bool enabled = true;
+
+   enum class event
+   {
+      none,
+      breakpoint,
+      read_watch,
+      write_watch,
+      value_watch,
+      register_watch
+   };
+
+   struct hit
+   {
+      event type = event::none;
+      std::size_t address = 0;
+      std::uint8_t old_value = 0x00;
+      std::uint8_t new_value = 0x00;
+   };
+
+   std::bitset<256> breakpoints;
+   std::vector<bool> read_watches;
+   std::vector<bool> write_watches;
+   std::vector<bool> value_watches;
+   std::vector<std::uint8_t> watch_values;
+   std::uint32_t register_watches = 0;
+
+   hit last_hit;
+   bool halted = false;
+   bool skip_breakpoint = false;
+
+   static void set_bit(std::vector<bool>& bitmap,
+                       const std::size_t address,
+                       const bool value = true)
+   {
+      if (address >= bitmap.size()) bitmap.resize(address + 1, false);
+      bitmap[address] = value;
+      return;
+   }
+
+   static bool test_bit(const std::vector<bool>& bitmap,
+                        const std::size_t address)
+   {
+      return address < bitmap.size() && bitmap[address];
+   }
+
+   void add_breakpoint(const std::uint8_t address)
+   {
+      breakpoints.set(address);
+      return;
+   }
+
+   void remove_breakpoint(const std::uint8_t address)
+   {
+      breakpoints.reset(address);
+      return;
+   }
+
+   void watch_read(const std::size_t address, const bool enable = true)
+   {
+      set_bit(read_watches, address, enable);
+      return;
+   }
+
+   void watch_write(const std::size_t address, const bool enable = true)
+   {
+      set_bit(write_watches, address, enable);
+      return;
+   }
+
+   void watch_value(const std::size_t address,
+                    const std::uint8_t value,
+                    const bool enable = true)
+   {
+      set_bit(value_watches, address, enable);
+      if (address >= watch_values.size()) watch_values.resize(address + 1, 0x00);
+      watch_values[address] = value;
+      return;
+   }
+
+   void watch_register(const std::uint8_t index, const bool enable = true)
+   {
+      if (enable) set(register_watches, index);
+      else clr(register_watches, index);
+      return;
+   }
+
+   void stop(const event type,
+             const std::size_t address,
+             const std::uint8_t old_value = 0x00,
+             const std::uint8_t new_value = 0x00)
+   {
+      last_hit = { type, address, old_value, new_value };
+      halted = true;
+      return;
+   }
+
+   bool check_breakpoint(const std::uint8_t pc)
+   {
+      if (halted) return true;
+
+      if (skip_breakpoint)
+      {
+         skip_breakpoint = false;
+         return false;
+      }
+
+      if (breakpoints.test(pc))
+      {
+         stop(event::breakpoint, pc);
+         return true;
+      }
+      return false;
+   }
+
+   void on_read(const std::size_t address, const std::uint8_t value)
+   {
+      if (test_bit(read_watches, address)) stop(event::read_watch, address, value, value);
+      return;
+   }
+
+   void on_write(const std::size_t address,
+                 const std::uint8_t old_value,
+                 const std::uint8_t new_value)
+   {
+      if (test_bit(write_watches, address))
+      {
+         stop(event::write_watch, address, old_value, new_value);
+      }
+      else if (test_bit(value_watches, address) && watch_values[address] == new_value)
+      {
+         stop(event::value_watch, address, old_value, new_value);
+      }
+      return;
+   }
+
+   template<std::size_t N>
+   void on_register_change(const std::array<std::uint8_t, N>& old_reg,
+                           const std::array<std::uint8_t, N>& new_reg)
+   {
+      if (!register_watches) return;
+
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         if (read(register_watches, static_cast<std::uint8_t>(i)) && old_reg[i] != new_reg[i])
+         {
+            stop(event::register_watch, i, old_reg[i], new_reg[i]);
+            return;
+         }
+      }
+      return;
+   }
+
+   void resume(void)
+   {
+      halted = false;
+      skip_breakpoint = last_hit.type == event::breakpoint;
+      last_hit = hit{};
+      return;
+   }
+};
+
+#endif /* DEBUGGER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,372 @@
+#ifndef DEMO_NATIVE_HPP_
+#define DEMO_NATIVE_HPP_
+
+#include "cpu.hpp"
+
+namespace cpu
+{
+   struct demo_native;
+}
+
+/* Generated by cpu::recompiler from a program image of 43 instructions, do not edit. */
+struct cpu::demo_native
+{
+   static constexpr std::uint64_t IMAGE_HASH = 0xF90603858AADF75;
+
+   template<class control_unit_type>
+   static void run(control_unit_type& unit, const std::uint64_t num_instructions)
+   {
+      auto& core = unit.core;
+      const auto end = core.num_instructions + num_instructions;
+      if (core.current_state != state::fetch || unit.data_mem().read(PINB) != core.last_input)
+      {
+         unit.step();
+         goto boundary;
+      }
+      goto dispatch;
+
+   boundary:
+      unit.monitor_interrupts();
+      if (core.num_instructions >= end) return;
+
+   dispatch:
+      switch (core.pc)
+      {
+         case 0x00: goto block_0x00;
+         case 0x01: goto block_0x01;
+         case 0x02: goto block_0x02;
+         case 0x03: goto block_0x03;
+         case 0x04: goto block_0x04;
+         case 0x05: goto block_0x05;
+         case 0x07: goto block_0x07;
+         case 0x08: goto block_0x08;
+         case 0x09: goto block_0x09;
+         case 0x0A: goto block_0x0A;
+         case 0x0B: goto block_0x0B;
+         case 0x0E: goto block_0x0E;
+         case 0x0F: goto block_0x0F;
+         case 0x10: goto block_0x10;
+         case 0x16: goto block_0x16;
+         case 0x1C: goto block_0x1C;
+         case 0x21: goto block_0x21;
+         case 0x23: goto block_0x23;
+         case 0x25: goto block_0x25;
+         case 0x28: goto block_0x28;
+         default: unit.step(); goto boundary;
+      }
+
+   block_0x00: /* RESET_vect */
+      /* JMP 0x09, 0x00 */
+      core.pc = 0x09;
+      core.cycles += 3;
+      core.num_instructions += 1;
+      core.mar = 0x00;
+      core.ir = 0x160900;
+      core.op_code = 0x16;
+      core.op1 = 0x09;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x01: /* Unknown */
+      /* NOP 0x00, 0x00 */
+      core.cycles += 1;
+      core.num_instructions += 1;
+
+   block_0x02: /* PCINT0_vect */
+      /* JMP 0x04, 0x00 */
+      core.pc = 0x04;
+      core.cycles += 3;
+      core.num_instructions += 1;
+      core.mar = 0x02;
+      core.ir = 0x160400;
+      core.op_code = 0x16;
+      core.op1 = 0x04;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x03: /* Unknown */
+      /* NOP 0x00, 0x00 */
+      core.cycles += 1;
+      core.num_instructions += 1;
+
+   block_0x04: /* ISR (PCINT0_vect) */
+      /* CALL 0x28, 0x00 */
+      unit.stack().push(0x05);
+      core.pc = 0x28;
+      core.cycles += 4;
+      core.num_instructions += 1;
+      core.mar = 0x04;
+      core.ir = 0x172800;
+      core.op_code = 0x17;
+      core.op1 = 0x28;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x05: /* ISR (PCINT0_vect) */
+      /* CPI 0x18, 0x00 */
+      unit.compare(core.reg[0x18], 0x00);
+      /* BREQ 0x08, 0x00 */
+      if (unit.equal())
+      {
+         core.pc = 0x08;
+         core.cycles += 2;
+      }
+      else
+      {
+         core.pc = 0x07;
+         core.cycles += 1;
+      }
+      core.cycles += 1;
+      core.num_instructions += 2;
+      core.mar = 0x06;
+      core.ir = 0x190800;
+      core.op_code = 0x19;
+      core.op1 = 0x08;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x07: /* ISR (PCINT0_vect) */
+      /* CALL 0x0B, 0x00 */
+      unit.stack().push(0x08);
+      core.pc = 0x0B;
+      core.cycles += 4;
+      core.num_instructions += 1;
+      core.mar = 0x07;
+      core.ir = 0x170B00;
+      core.op_code = 0x17;
+      core.op1 = 0x0B;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x08: /* ISR (PCINT0_vect) */
+      /* RETI */
+      core.pc = 0x08;
+      unit.step();
+      goto boundary;
+
+   block_0x09: /* main */
+      /* CALL 0x1C, 0x00 */
+      unit.stack().push(0x0A);
+      core.pc = 0x1C;
+      core.cycles += 4;
+      core.num_instructions += 1;
+      core.mar = 0x09;
+      core.ir = 0x171C00;
+      core.op_code = 0x17;
+      core.op1 = 0x1C;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x0A: /* main */
+      /* JMP 0x0A, 0x00 */
+      core.pc = 0x0A;
+      core.cycles += 3;
+      core.num_instructions += 1;
+      core.mar = 0x0A;
+      core.ir = 0x160A00;
+      core.op_code = 0x16;
+      core.op1 = 0x0A;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x0B: /* led_toggle */
+      /* LDS 0x10, 0x64 */
+      core.reg[0x10] = unit.read_data(0x64);
+      core.reg[0x11] = unit.read_data(0x65);
+      /* CPI 0x10, 0x00 */
+      unit.compare(core.reg[0x10], 0x00);
+      /* BREQ 0x10, 0x00 */
+      if (unit.equal())
+      {
+         core.pc = 0x10;
+         core.cycles += 2;
+      }
+      else
+      {
+         core.pc = 0x0E;
+         core.cycles += 1;
+      }
+      core.cycles += 3;
+      core.num_instructions += 3;
+      core.mar = 0x0D;
+      core.ir = 0x191000;
+      core.op_code = 0x19;
+      core.op1 = 0x10;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x0E: /* led_toggle */
+      /* JMP 0x16, 0x00 */
+      core.pc = 0x16;
+      core.cycles += 3;
+      core.num_instructions += 1;
+      core.mar = 0x0E;
+      core.ir = 0x161600;
+      core.op_code = 0x16;
+      core.op1 = 0x16;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x0F: /* led_toggle */
+      /* RET 0x00, 0x00 */
+      unit.stack().pop(core.pc);
+      core.cycles += 4;
+      core.num_instructions += 1;
+      core.mar = 0x0F;
+      core.ir = 0x180000;
+      core.op_code = 0x18;
+      core.op1 = 0x00;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x10: /* led_on */
+      /* IN 0x10, 0x01 */
+      core.reg[0x10] = unit.read_data(0x01);
+      /* ORI 0x10, 0x01 */
+      {
+         const std::uint8_t a = core.reg[0x10];
+         const std::uint8_t b = 0x01;
+         const std::uint16_t result = a | b;
+         core.sr |= control_unit_type::get_status_bits(result, a, b);
+         core.reg[0x10] = static_cast<std::uint8_t>(result);
+      }
+      /* OUT 0x01, 0x10 */
+      unit.write_data(0x01, core.reg[0x10]);
+      /* LDI 0x10, 0x01 */
+      core.reg[0x10] = 0x01;
+      /* STS 0x64, 0x10 */
+      unit.write_data(0x64, core.reg[0x10]);
+      unit.write_data(0x65, core.reg[0x11]);
+      /* JMP 0x0F, 0x00 */
+      core.pc = 0x0F;
+      core.cycles += 9;
+      core.num_instructions += 6;
+      core.mar = 0x15;
+      core.ir = 0x160F00;
+      core.op_code = 0x16;
+      core.op1 = 0x0F;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x16: /* led_off */
+      /* IN 0x10, 0x01 */
+      core.reg[0x10] = unit.read_data(0x01);
+      /* ANDI 0x10, 0xFE */
+      {
+         const std::uint8_t a = core.reg[0x10];
+         const std::uint8_t b = 0xFE;
+         const std::uint16_t result = a & b;
+         core.sr |= control_unit_type::get_status_bits(result, a, b);
+         core.reg[0x10] = static_cast<std::uint8_t>(result);
+      }
+      /* OUT 0x01, 0x10 */
+      unit.write_data(0x01, core.reg[0x10]);
+      /* LDI 0x10, 0x00 */
+      core.reg[0x10] = 0x00;
+      /* STS 0x64, 0x10 */
+      unit.write_data(0x64, core.reg[0x10]);
+      unit.write_data(0x65, core.reg[0x11]);
+      /* JMP 0x0F, 0x00 */
+      core.pc = 0x0F;
+      core.cycles += 9;
+      core.num_instructions += 6;
+      core.mar = 0x1B;
+      core.ir = 0x160F00;
+      core.op_code = 0x16;
+      core.op1 = 0x0F;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x1C: /* setup */
+      /* LDI 0x10, 0x01 */
+      core.reg[0x10] = 0x01;
+      /* OUT 0x00, 0x10 */
+      unit.write_data(0x00, core.reg[0x10]);
+      /* LDI 0x10, 0x20 */
+      core.reg[0x10] = 0x20;
+      /* OUT 0x01, 0x10 */
+      unit.write_data(0x01, core.reg[0x10]);
+      /* SEI 0x00, 0x00 */
+      set(core.sr, control_unit_type::I);
+      core.pc = 0x21;
+      core.cycles += 5;
+      core.num_instructions += 5;
+      core.mar = 0x20;
+      core.ir = 0x210000;
+      core.op_code = 0x21;
+      core.op1 = 0x00;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x21: /* setup */
+      /* LDI 0x10, 0x01 */
+      core.reg[0x10] = 0x01;
+      /* OUT 0x03, 0x10 */
+      unit.write_data(0x03, core.reg[0x10]);
+      core.pc = 0x23;
+      core.cycles += 2;
+      core.num_instructions += 2;
+      core.mar = 0x22;
+      core.ir = 0x30310;
+      core.op_code = 0x03;
+      core.op1 = 0x03;
+      core.op2 = 0x10;
+      goto boundary;
+
+   block_0x23: /* setup */
+      /* LDI 0x10, 0x20 */
+      core.reg[0x10] = 0x20;
+      /* OUT 0x04, 0x10 */
+      unit.write_data(0x04, core.reg[0x10]);
+      core.pc = 0x25;
+      core.cycles += 2;
+      core.num_instructions += 2;
+      core.mar = 0x24;
+      core.ir = 0x30410;
+      core.op_code = 0x03;
+      core.op1 = 0x04;
+      core.op2 = 0x10;
+      goto boundary;
+
+   block_0x25: /* setup */
+      /* CLR 0x10, 0x00 */
+      core.reg[0x10] = 0x00;
+      /* STS 0x64, 0x10 */
+      unit.write_data(0x64, core.reg[0x10]);
+      unit.write_data(0x65, core.reg[0x11]);
+      /* RET 0x00, 0x00 */
+      unit.stack().pop(core.pc);
+      core.cycles += 7;
+      core.num_instructions += 3;
+      core.mar = 0x27;
+      core.ir = 0x180000;
+      core.op_code = 0x18;
+      core.op1 = 0x00;
+      core.op2 = 0x00;
+      goto boundary;
+
+   block_0x28: /* button_is_pressed */
+      /* IN 0x18, 0x02 */
+      core.reg[0x18] = unit.read_data(0x02);
+      /* ANDI 0x18, 0x20 */
+      {
+         const std::uint8_t a = core.reg[0x18];
+         const std::uint8_t b = 0x20;
+         const std::uint16_t result = a & b;
+         core.sr |= control_unit_type::get_status_bits(result, a, b);
+         core.reg[0x18] = static_cast<std::uint8_t>(result);
+      }
+      /* RET 0x00, 0x00 */
+      unit.stack().pop(core.pc);
+      core.cycles += 6;
+      core.num_instructions += 3;
+      core.mar = 0x2A;
+      core.ir = 0x180000;
+      core.op_code = 0x18;
+      core.op1 = 0x00;
+      core.op2 = 0x00;
+      goto boundary;
+   }
+};
+
+#endif /* DEMO_NATIVE_HPP_ */
\ No newline at end of file
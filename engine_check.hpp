@@ -0,0 +1,109 @@
+#ifndef ENGINE_CHECK_HPP_
+#define ENGINE_CHECK_HPP_
+
+#include "control_unit.hpp"
+#include "cpu.hpp"
+
+/* Differential check of an execution engine against the interpreter. Two
+   control units start from reset and get the same random PINB value before
+   every run of the engine. After each run the interpreter is stepped to the
+   same instruction count, and the core state and the memory block of both
+   control units are compared. */
+struct cpu::engine_check
+{
+   using runner = std::function<void(control_unit<>&, std::uint64_t)>;
+
+   struct mismatch
+   {
+      std::size_t run = 0;
+      std::uint8_t pc = 0x00;
+      std::uint8_t expected_pc = 0x00;
+      std::uint64_t cycles = 0;
+      std::uint64_t expected_cycles = 0;
+   };
+
+   std::shared_ptr<const program_image> image;
+   runner execute;
+   std::uint64_t max_run_length = 4;
+
+   std::size_t num_runs = 0;
+   std::size_t num_mismatches = 0;
+   std::uint64_t num_instructions = 0;
+   std::uint64_t num_interrupts = 0;
+   std::vector<mismatch> mismatches;
+
+   engine_check(std::shared_ptr<const program_image> image,
+                runner execute,
+                const std::uint64_t max_run_length = 4)
+      : image{std::move(image)}
+      , execute{std::move(execute)}
+      , max_run_length{max_run_length} { }
+
+   static bool same_state(const control_unit<>& unit,
+                          const control_unit<>& reference)
+   {
+      const auto& a = unit.core;
+      const auto& b = reference.core;
+
+      return a.reg == b.reg && a.pc == b.pc && a.sr == b.sr && a.sp == b.sp &&
+             a.stack_empty == b.stack_empty && a.pending == b.pending && a.last_input == b.last_input &&
+             a.cycles == b.cycles && a.num_instructions == b.num_instructions &&
+             a.num_interrupts == b.num_interrupts && unit.memory == reference.memory;
+   }
+
+   void run(const std::size_t runs, const std::size_t max_reported = 3)
+   {
+      control_unit<> unit{image};
+      control_unit<> reference{image};
+      std::uint64_t seed = 0x2545F4914F6CDD1D;
+
+      for (std::size_t i = 0; i < runs; ++i)
+      {
+         seed = seed * 6364136223846793005 + 1442695040888963407;
+         const auto pinb = static_cast<std::uint8_t>(seed >> 56);
+
+         unit.data_mem().write(PINB, pinb);
+         reference.data_mem().write(PINB, pinb);
+         execute(unit, 1 + (seed >> 33) % max_run_length);
+
+         while (reference.core.num_instructions < unit.core.num_instructions)
+         {
+            reference.step();
+         }
+
+         if (!same_state(unit, reference))
+         {
+            if (mismatches.size() < max_reported)
+            {
+               mismatches.push_back({ i, unit.core.pc, reference.core.pc, unit.core.cycles, reference.core.cycles });
+            }
+            num_mismatches++;
+         }
+      }
+
+      num_runs += runs;
+      num_instructions = unit.core.num_instructions;
+      num_interrupts = unit.core.num_interrupts;
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Engine runs:\t\t\t\t\t" << num_runs << "\n";
+      ostream << "Executed instructions:\t\t\t\t" << num_instructions << "\n";
+      ostream << "Interrupts:\t\t\t\t\t" << num_interrupts << "\n";
+      ostream << "Mismatches with the interpreter:\t\t" << num_mismatches << "\n";
+
+      for (const auto& i : mismatches)
+      {
+         ostream << "Run " << i.run << ": pc " << static_cast<int>(i.pc) << ", expected " << static_cast<int>(i.expected_pc)
+                 << ", cycles " << i.cycles << ", expected " << i.expected_cycles << "\n";
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* ENGINE_CHECK_HPP_ */
\ No newline at end of file
@@ -0,0 +1,256 @@
+#ifndef EXPLORER_HPP_
+#define EXPLORER_HPP_
+
+#include "control_unit.hpp"
+#include "cpu.hpp"
+
+/* Set of state fingerprints shared by all explorer threads. The set is
+   split into shards with a lock each, selected by the upper bits of the
+   fingerprint, so that threads rarely wait for each other. */
+struct cpu::fingerprint_set
+{
+   static constexpr std::size_t NUM_SHARDS = 64;
+
+   struct alignas(64) shard
+   {
+      std::mutex mutex;
+      std::unordered_set<std::uint64_t> fingerprints;
+   };
+
+   std::array<shard, NUM_SHARDS> shards;
+
+   bool insert(const std::uint64_t fingerprint)
+   {
+      auto& shard = shards[(fingerprint >> 58) % NUM_SHARDS];
+      const std::lock_guard<std::mutex> lock{shard.mutex};
+      return shard.fingerprints.insert(fingerprint).second;
+   }
+
+   std::size_t size(void)
+   {
+      std::size_t size = 0;
+
+      for (auto& i : shards)
+      {
+         const std::lock_guard<std::mutex> lock{i.mutex};
+         size += i.fingerprints.size();
+      }
+      return size;
+   }
+};
+
+/* Breadth first exploration of all PINB input sequences up to a bounded
+   depth. Each state is a copy of a control unit waiting for input, which is
+   forked once for every input value differing from the current PINB and
+   run until it waits for input again. A property is checked each time the
+   outermost interrupt service routine returns. States already visited by
+   any thread are recognized by their fingerprint and not explored again. */
+struct cpu::explorer
+{
+   using property = std::function<bool(const control_unit<>&)>;
+
+   struct node
+   {
+      control_unit<> unit;
+      std::vector<std::uint8_t> trace;
+   };
+
+   struct violation
+   {
+      std::vector<std::uint8_t> trace;
+      std::uint8_t pc = 0x00;
+      std::uint8_t portb = 0x00;
+   };
+
+   std::shared_ptr<const program_image> image;
+   std::vector<std::uint8_t> inputs;
+   property check;
+   std::uint64_t max_instructions = 100000;
+
+   fingerprint_set visited;
+   std::vector<violation> violations;
+   std::mutex violation_mutex;
+   std::atomic<std::uint64_t> num_states{0};
+   std::atomic<std::uint64_t> num_unsettled{0};
+   std::size_t num_unique = 0;
+   std::size_t depth_reached = 0;
+   double wall_time = 0.0;
+
+   explorer(std::shared_ptr<const program_image> image,
+            const std::uint8_t input_mask = (1 << program_memory::BUTTON1),
+            property check = led_matches_led_enabled)
+      : image{std::move(image)}
+      , check{std::move(check)}
+   {
+      for (auto i = 0; i <= 0xFF; ++i)
+      {
+         if ((i & ~input_mask) == 0) inputs.push_back(static_cast<std::uint8_t>(i));
+      }
+      return;
+   }
+
+   static bool led_matches_led_enabled(const control_unit<>& unit)
+   {
+      const auto led = read(unit.data_mem().read(PORTB), program_memory::LED1) != 0;
+      const auto led_enabled = unit.data_mem().read(program_memory::led_enabled) != 0;
+      return led == led_enabled;
+   }
+
+   static std::uint64_t fingerprint(const control_unit<>& unit)
+   {
+      const auto& core = unit.core;
+      std::uint64_t hash = 0xCBF29CE484222325;
+
+      const auto mix = [&hash](const std::uint64_t word)
+      {
+         hash = (hash ^ word) * 0x9E3779B97F4A7C15;
+         hash ^= hash >> 32;
+         return;
+      };
+
+      for (std::size_t i = 0; i < core.reg.size(); i += sizeof(std::uint64_t))
+      {
+         std::uint64_t word = 0;
+         std::memcpy(&word, core.reg.data() + i, sizeof(word));
+         mix(word);
+      }
+
+      mix(core.ir);
+      mix(core.pc | core.mar << 8 | core.sr << 16 | core.op_code << 24 |
+          static_cast<std::uint64_t>(core.op1) << 32 | static_cast<std::uint64_t>(core.op2) << 40 |
+          static_cast<std::uint64_t>(core.current_state) << 48 | static_cast<std::uint64_t>(core.last_input) << 56);
+      mix(core.pending | core.stack_empty << 8 | static_cast<std::uint64_t>(core.sp) << 16);
+      mix(unit.interrupt_depth);
+
+      const auto memory_size = unit.memory.size();
+      std::size_t i = 0;
+
+      for (; i + sizeof(std::uint64_t) <= memory_size; i += sizeof(std::uint64_t))
+      {
+         std::uint64_t word = 0;
+         std::memcpy(&word, unit.memory.data() + i, sizeof(word));
+         mix(word);
+      }
+
+      for (; i < memory_size; ++i)
+      {
+         mix(unit.memory[i]);
+      }
+      return hash;
+   }
+
+   bool settle(control_unit<>& unit, const std::vector<std::uint8_t>& trace)
+   {
+      for (std::uint64_t i = 0; i < max_instructions; ++i)
+      {
+         const auto interrupt_depth = unit.interrupt_depth;
+         unit.step();
+
+         if (interrupt_depth > 0 && unit.interrupt_depth == 0 && check && !check(unit))
+         {
+            const std::lock_guard<std::mutex> lock{violation_mutex};
+            violations.push_back({ trace, unit.core.pc, unit.data_mem().read(PORTB) });
+            return false;
+         }
+
+         if (unit.waiting_for_input()) return true;
+      }
+
+      num_unsettled++;
+      return true;
+   }
+
+   void expand(const node& parent, std::vector<node>& next)
+   {
+      const auto pinb = parent.unit.data_mem().read(PINB);
+
+      for (const auto input : inputs)
+      {
+         if (input == pinb) continue;
+
+         node child{ parent.unit, parent.trace };
+         child.trace.push_back(input);
+         child.unit.data_mem().write(PINB, input);
+         num_states++;
+
+         if (!settle(child.unit, child.trace)) continue;
+         if (visited.insert(fingerprint(child.unit))) next.push_back(std::move(child));
+      }
+      return;
+   }
+
+   void run(const std::size_t max_depth, const std::size_t num_threads = 1)
+   {
+      const auto start_time = std::chrono::steady_clock::now();
+      std::vector<node> frontier;
+
+      frontier.push_back({ control_unit<>{image}, {} });
+      settle(frontier.back().unit, {});
+      visited.insert(fingerprint(frontier.back().unit));
+      num_states++;
+
+      for (depth_reached = 0; depth_reached < max_depth && !frontier.empty(); ++depth_reached)
+      {
+         std::vector<std::vector<node>> next(num_threads);
+         std::vector<std::thread> threads;
+         std::atomic<std::size_t> next_node{0};
+
+         for (std::size_t i = 0; i < num_threads; ++i)
+         {
+            threads.emplace_back([this, &frontier, &next, &next_node, i]()
+            {
+               for (auto j = next_node++; j < frontier.size(); j = next_node++)
+               {
+                  expand(frontier[j], next[i]);
+               }
+            });
+         }
+
+         for (auto& i : threads)
+         {
+            i.join();
+         }
+
+         frontier.clear();
+
+         for (auto& i : next)
+         {
+            std::move(i.begin(), i.end(), std::back_inserter(frontier));
+         }
+      }
+
+      num_unique = visited.size();
+      wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Explored depth:\t\t\t\t\t" << depth_reached << "\n";
+      ostream << "Input values per state:\t\t\t\t" << inputs.size() << "\n";
+      ostream << "Explored states:\t\t\t\t" << num_states << "\n";
+      ostream << "Unique states:\t\t\t\t\t" << num_unique << "\n";
+      ostream << "States not settled:\t\t\t\t" << num_unsettled << "\n";
+      ostream << "Wall clock time:\t\t\t\t" << wall_time << " s\n";
+      ostream << "Explored states per second:\t\t\t" << (wall_time > 0 ? num_states / wall_time : 0.0) << "\n";
+      ostream << "Property violations:\t\t\t\t" << violations.size() << "\n";
+
+      for (const auto& i : violations)
+      {
+         ostream << "\nViolation at address " << static_cast<int>(i.pc) << ", PORTB "
+                 << std::bitset<8>(i.portb) << ", PINB sequence:";
+
+         for (const auto j : i.trace)
+         {
+            ostream << " " << std::bitset<8>(j);
+         }
+         ostream << "\n";
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* EXPLORER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,252 @@
+#ifndef FLEET_HPP_
+#define FLEET_HPP_
+
+#include "scheduler.hpp"
+#include "checkpoint.hpp"
+#include "demo_native.hpp"
+#include "specialized_engine.hpp"
+#include "cpu.hpp"
+
+/* Many simulated boards running the same program image. The run loop of
+   each board is a coroutine, which yields every quantum of instructions and
+   sleeps in the scheduler until its next PINB event when the CPU is busy
+   waiting in a jump to itself. The skipped cycles are added to the cycle
+   counter of the board when it wakes up. Boards start from a checkpoint if
+   one is given; a checkpoint of another program image leaves the fleet
+   without boards. */
+struct cpu::fleet
+{
+   struct input_event
+   {
+      std::uint64_t cycle = 0;
+      std::uint8_t value = 0x00;
+   };
+
+   struct board
+   {
+      control_unit<> unit;
+      std::vector<input_event> events;
+      std::size_t next_event = 0;
+      std::uint64_t num_instructions = 0;
+
+      board(std::shared_ptr<const program_image> image)
+         : unit{std::move(image)} { }
+
+      bool apply_due_events(void)
+      {
+         auto applied = false;
+
+         while (next_event < events.size() && events[next_event].cycle <= unit.core.cycles)
+         {
+            unit.data_mem().write(PINB, events[next_event++].value);
+            applied = true;
+         }
+         return applied;
+      }
+   };
+
+   std::vector<board> boards;
+   std::size_t quantum = 64;
+   std::uint64_t horizon = 0;
+   std::uint64_t num_resumes = 0;
+   double wall_time = 0.0;
+
+   fleet(const std::shared_ptr<const program_image>& image,
+         const std::size_t num_boards,
+         const std::uint64_t horizon,
+         const checkpoint* start = nullptr,
+         const std::uint64_t press_interval = 1000000)
+      : horizon{horizon}
+   {
+      std::uint64_t seed = 0x2545F4914F6CDD1D;
+      boards.reserve(num_boards);
+
+      for (std::size_t i = 0; i < num_boards; ++i)
+      {
+         auto& new_board = boards.emplace_back(image);
+
+         if (start && start->restore(new_board.unit) != 0)
+         {
+            boards.clear();
+            return;
+         }
+
+         std::uint64_t cycle = new_board.unit.core.cycles;
+
+         while (true)
+         {
+            seed = seed * 6364136223846793005 + 1442695040888963407;
+            cycle += press_interval / 2 + (seed >> 33) % press_interval;
+            if (cycle >= horizon) break;
+
+            new_board.events.push_back({ cycle, (1 << program_memory::BUTTON1) });
+            new_board.events.push_back({ cycle + press_interval / 10, 0x00 });
+         }
+      }
+      return;
+   }
+
+   static task run_board(scheduler& scheduler,
+                         board& board,
+                         const std::size_t quantum,
+                         const std::uint64_t horizon)
+   {
+      auto& unit = board.unit;
+
+      while (unit.core.cycles < horizon)
+      {
+         for (std::size_t i = 0; i < quantum; ++i)
+         {
+            unit.step();
+            board.num_instructions++;
+            if (unit.waiting_for_input()) break;
+         }
+
+         if (board.apply_due_events()) continue;
+
+         if (unit.waiting_for_input())
+         {
+            if (board.next_event >= board.events.size())
+            {
+               unit.core.cycles = horizon;
+               co_return;
+            }
+
+            const auto wake_time = board.events[board.next_event].cycle;
+
+            co_await scheduler.sleep_until(wake_time);
+            if (unit.core.cycles < wake_time) unit.core.cycles = wake_time;
+            board.apply_due_events();
+         }
+         else
+         {
+            co_await scheduler.yield();
+         }
+      }
+      co_return;
+   }
+
+   void run(const std::size_t num_threads = 1)
+   {
+      const auto start_time = std::chrono::steady_clock::now();
+      const auto boards_per_thread = (boards.size() + num_threads - 1) / num_threads;
+      std::vector<std::thread> threads;
+      std::atomic<std::uint64_t> total_resumes{0};
+
+      for (std::size_t i = 0; i < num_threads; ++i)
+      {
+         const auto first = std::min(boards.size(), i * boards_per_thread);
+         const auto last = std::min(boards.size(), first + boards_per_thread);
+
+         threads.emplace_back([this, first, last, &total_resumes]()
+         {
+            scheduler scheduler;
+
+            for (auto j = first; j < last; ++j)
+            {
+               scheduler.spawn(run_board(scheduler, boards[j], quantum, horizon));
+            }
+
+            scheduler.run();
+            total_resumes += scheduler.num_resumes;
+         });
+      }
+
+      for (auto& i : threads)
+      {
+         i.join();
+      }
+
+      num_resumes = total_resumes;
+      wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+      return;
+   }
+
+   static void benchmark(const std::shared_ptr<const program_image>& image,
+                         const std::size_t num_boards,
+                         const std::size_t num_rounds,
+                         const std::size_t instructions_per_round = 16,
+                         const engine execution_engine = engine::interpreter,
+                         const specialized_engine<control_unit<>>* specialized = nullptr,
+                         std::ostream& ostream = std::cout)
+   {
+      std::vector<control_unit<>> units;
+      units.reserve(num_boards);
+
+      for (std::size_t i = 0; i < num_boards; ++i)
+      {
+         units.emplace_back(image);
+      }
+
+      const auto start_time = std::chrono::steady_clock::now();
+
+      for (std::size_t i = 0; i < num_rounds; ++i)
+      {
+         const auto pinb = static_cast<std::uint8_t>((i / 64) % 2 ? (1 << program_memory::BUTTON1) : 0x00);
+
+         for (auto& unit : units)
+         {
+            unit.data_mem().write(PINB, pinb);
+
+            if (execution_engine == engine::native)
+            {
+               demo_native::run(unit, instructions_per_round);
+            }
+            else if (execution_engine == engine::specialized && specialized)
+            {
+               specialized->run(unit, instructions_per_round);
+            }
+            else
+            {
+               for (std::size_t j = 0; j < instructions_per_round; ++j)
+               {
+                  unit.step();
+               }
+            }
+         }
+      }
+
+      const auto wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+      auto num_instructions = 0.0;
+
+      for (const auto& unit : units)
+      {
+         num_instructions += unit.core.num_instructions;
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Number of boards:\t\t\t\t" << num_boards << "\n";
+      ostream << "Execution engine:\t\t\t\t" << engine_name(execution_engine) << "\n";
+      ostream << "Size of control unit:\t\t\t\t" << sizeof(control_unit<>) << " bytes\n";
+      ostream << "Executed instructions:\t\t\t\t" << num_instructions << "\n";
+      ostream << "Wall clock time:\t\t\t\t" << wall_time << " s\n";
+      ostream << "Executed instructions per second:\t\t" << (wall_time > 0 ? num_instructions / wall_time : 0.0) << "\n";
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      std::uint64_t num_instructions = 0;
+      std::uint64_t num_cycles = 0;
+
+      for (const auto& i : boards)
+      {
+         num_instructions += i.num_instructions;
+         num_cycles += i.unit.core.cycles;
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Number of boards:\t\t\t\t" << boards.size() << "\n";
+      ostream << "Simulated cycles per board:\t\t\t" << horizon << "\n";
+      ostream << "Executed instructions:\t\t\t\t" << num_instructions << "\n";
+      ostream << "Simulated cycles:\t\t\t\t" << num_cycles << "\n";
+      ostream << "Coroutine resumes:\t\t\t\t" << num_resumes << "\n";
+      ostream << "Wall clock time:\t\t\t\t" << wall_time << " s\n";
+      ostream << "Executed instructions per second:\t\t" << (wall_time > 0 ? num_instructions / wall_time : 0.0) << "\n";
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* FLEET_HPP_ */
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef HEATMAP_HPP_
+#define HEATMAP_HPP_
+
+#include "cpu.hpp"
+
+/* Memory usage policies for the control unit. With no_heatmap, every
+   counter is removed at compile time. The heatmap counts reads and writes
+   per data memory address with saturating 32-bit counters, the stack
+   pushes and pops per source and the high-water mark of the stack, so
+   that memory sizes can be chosen from soak runs. */
+struct cpu::no_heatmap
+{
+   static constexpr bool enabled = false;
+};
+
+struct cpu::heatmap
+{
+   static constexpr bool enabled = true;
+
+   std::vector<std::uint32_t> reads;
+   std::vector<std::uint32_t> writes;
+   std::array<std::uint64_t, NUM_STACK_SOURCES> pushes{};
+   std::array<std::uint64_t, NUM_STACK_SOURCES> pops{};
+   std::size_t stack_high_water_mark = 0;
+
+   static void count(std::vector<std::uint32_t>& counters,
+                     const std::size_t address)
+   {
+      if (address >= counters.size()) counters.resize(address + 1, 0);
+      if (counters[address] < UINT32_MAX) counters[address]++;
+      return;
+   }
+
+   void on_read(const std::size_t address)
+   {
+      count(reads, address);
+      return;
+   }
+
+   void on_write(const std::size_t address)
+   {
+      count(writes, address);
+      return;
+   }
+
+   static stack_source stack_source_of(const std::uint8_t instruction)
+   {
+      if (instruction == RETI) return stack_source::interrupt;
+      else if (instruction == CALL || instruction == RET) return stack_source::call;
+      else return stack_source::push;
+   }
+
+   void on_stack_change(const stack_source source,
+                        const std::size_t previous_usage,
+                        const std::size_t new_usage)
+   {
+      if (new_usage > previous_usage)
+      {
+         pushes[static_cast<std::size_t>(source)] += new_usage - previous_usage;
+         if (new_usage > stack_high_water_mark) stack_high_water_mark = new_usage;
+      }
+      else
+      {
+         pops[static_cast<std::size_t>(source)] += previous_usage - new_usage;
+      }
+      return;
+   }
+
+   std::size_t data_memory_used(void) const
+   {
+      for (auto i = std::max(reads.size(), writes.size()); i > 0; --i)
+      {
+         if ((i <= reads.size() && reads[i - 1]) || (i <= writes.size() && writes[i - 1])) return i;
+      }
+      return 0;
+   }
+
+   int save(const std::string& filename) const
+   {
+      std::ofstream file(filename);
+      if (!file) return 1;
+
+      file << "# stack <high-water mark in bytes>\n";
+      file << "stack " << stack_high_water_mark << "\n";
+      file << "# push|pop <source> <count>\n";
+
+      for (std::size_t i = 0; i < NUM_STACK_SOURCES; ++i)
+      {
+         file << "push " << stack_source_name(static_cast<stack_source>(i)) << " " << pushes[i] << "\n";
+         file << "pop " << stack_source_name(static_cast<stack_source>(i)) << " " << pops[i] << "\n";
+      }
+
+      file << "# <address> <reads> <writes>, addresses never accessed are left out\n";
+      const auto num_used = data_memory_used();
+
+      for (std::size_t i = 0; i < num_used; ++i)
+      {
+         const auto num_reads = i < reads.size() ? reads[i] : 0;
+         const auto num_writes = i < writes.size() ? writes[i] : 0;
+         if (num_reads || num_writes) file << i << " " << num_reads << " " << num_writes << "\n";
+      }
+      return file ? 0 : 1;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      std::size_t num_addresses = 0;
+      const auto num_used = data_memory_used();
+
+      for (std::size_t i = 0; i < num_used; ++i)
+      {
+         if ((i < reads.size() && reads[i]) || (i < writes.size() && writes[i])) num_addresses++;
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Data memory addresses accessed:\t\t\t" << num_addresses << "\n";
+      ostream << "Data memory size needed:\t\t\t" << num_used << " bytes\n";
+      ostream << "Stack high-water mark:\t\t\t\t" << stack_high_water_mark << " bytes\n\n";
+
+      for (std::size_t i = 0; i < NUM_STACK_SOURCES; ++i)
+      {
+         ostream << "Stack pushes/pops (" << stack_source_name(static_cast<stack_source>(i)) << "):\t\t\t"
+                 << pushes[i] << "/" << pops[i] << "\n";
+      }
+
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* HEATMAP_HPP_ */
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef INTERRUPT_CONTROLLER_HPP_
+#define INTERRUPT_CONTROLLER_HPP_
+
+#include "program_memory.hpp"
+#include "core_state.hpp"
+#include "cpu.hpp"
+
+/* Interrupt controller latching requests of up to eight sources in the
+   pending register of the core. A lower source number has a higher
+   priority, like the vector order of the AVR. Requests stay pending while
+   interrupts are disabled and several requests of one source are coalesced
+   into a single one, which is delivered at the next instruction boundary.
+   Sources without an interrupt vector in the program memory cannot be
+   raised. */
+struct cpu::interrupt_controller
+{
+   static constexpr auto NUM_SOURCES = 8;
+   static constexpr auto PCINT0 = 0;
+   static constexpr std::uint8_t NO_VECTOR = 0xFF;
+
+   static constexpr std::array<std::uint8_t, NUM_SOURCES> vectors
+   {
+      program_memory::PCINT0_vect, NO_VECTOR, NO_VECTOR, NO_VECTOR,
+      NO_VECTOR, NO_VECTOR, NO_VECTOR, NO_VECTOR
+   };
+
+   static std::uint8_t detect_edges(const std::uint8_t last_input,
+                                    const std::uint8_t current_input,
+                                    const std::uint8_t mask)
+   {
+      return (last_input ^ current_input) & mask;
+   }
+
+   static void sample_pin_changes(core_state& core,
+                                  const std::uint8_t current_input,
+                                  const std::uint8_t pcicr,
+                                  const std::uint8_t pcmsk0)
+   {
+      if (read(pcicr, PCIE0) && detect_edges(core.last_input, current_input, pcmsk0))
+      {
+         set(core.pending, PCINT0);
+      }
+
+      core.last_input = current_input;
+      return;
+   }
+
+   static int raise(core_state& core, const std::uint8_t source)
+   {
+      if (source < NUM_SOURCES && vectors[source] != NO_VECTOR)
+      {
+         set(core.pending, source);
+         return 0;
+      }
+      else
+      {
+         return 1;
+      }
+   }
+
+   static std::uint8_t acknowledge(core_state& core)
+   {
+      const auto source = std::countr_zero(core.pending);
+      clr(core.pending, static_cast<std::uint8_t>(source));
+      return vectors[source];
+   }
+};
+
+#endif /* INTERRUPT_CONTROLLER_HPP_ */
\ No newline at end of file
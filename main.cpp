@@ -1,8 +1,263 @@
 #include "cpu.hpp"
 
-int main(void)
+int main(const int argc, const char** argv)
 {
-   cpu::control_unit control_unit1;
-   control_unit1.run_with_key_press();
+   const std::vector<std::string> args(argv + 1, argv + argc);
+   auto image = cpu::program_memory::demo_image();
+   std::string image_filename = "demo_image";
+   std::size_t i = 0;
+
+   if (args.size() >= 2 && args[0] == "--image")
+   {
+      image = cpu::program_image::load(args[1]);
+      image_filename = args[1];
+
+      if (!image)
+      {
+         std::cout << "Could not load program image " << args[1] << "!\n";
+         return 1;
+      }
+      i = 2;
+   }
+
+   std::unique_ptr<cpu::checkpoint> start;
+
+   if (args.size() >= i + 2 && args[i] == "--restore")
+   {
+      start = std::make_unique<cpu::checkpoint>(args[i + 1]);
+
+      if (!start->is_open())
+      {
+         std::cout << "Could not load checkpoint " << args[i + 1] << "!\n";
+         return 1;
+      }
+      i += 2;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--checkpoint")
+   {
+      cpu::control_unit<> control_unit1{image};
+
+      while (!control_unit1.waiting_for_input())
+      {
+         control_unit1.step();
+      }
+
+      std::cout << "Saved checkpoint after " << control_unit1.core.num_instructions << " instructions and "
+                << control_unit1.core.cycles << " cycles.\n";
+      return cpu::checkpoint::save(control_unit1, args[i + 1]);
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--recompile")
+   {
+      const cpu::recompiler recompiler{*image};
+      return recompiler.save(args[i + 1], args.size() >= i + 3 ? args[i + 2] : "native_image");
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--optimize")
+   {
+      cpu::optimizer optimizer;
+      const auto optimized_image = optimizer.optimize(*image);
+      optimizer.print_report();
+      return optimized_image->save(args[i + 1]);
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--perf")
+   {
+      cpu::control_unit<> control_unit1{image};
+      cpu::perf_report report;
+      const auto num_instructions = cpu::convert<std::uint64_t>(args[i + 1]);
+
+      if (args.size() >= i + 3 && args[i + 2] == "native")
+      {
+         if (image->hash() != cpu::demo_native::IMAGE_HASH)
+         {
+            std::cout << "The native engine was generated from another program image!\n";
+            return 1;
+         }
+
+         report.measure(control_unit1, num_instructions, [](cpu::control_unit<>& unit, const std::uint64_t n)
+         {
+            cpu::demo_native::run(unit, n);
+         }, cpu::engine::native);
+      }
+      else if (args.size() >= i + 3 && args[i + 2] == "specialized")
+      {
+         const auto profile = cpu::profile::load(*image, image_filename);
+
+         if (!profile)
+         {
+            std::cout << "No profile for the program image, record one with --profile!\n";
+            return 1;
+         }
+
+         const cpu::specialized_engine<> specialized{*image, *profile};
+
+         report.measure(control_unit1, num_instructions, [&specialized](cpu::control_unit<>& unit, const std::uint64_t n)
+         {
+            specialized.run(unit, n);
+         }, cpu::engine::specialized);
+      }
+      else
+      {
+         report.measure(control_unit1, num_instructions);
+      }
+
+      report.print();
+      return 0;
+   }
+
+   if (args.size() >= i + 3 && args[i] == "--heatmap")
+   {
+      cpu::control_unit<cpu::no_debug, cpu::heatmap> control_unit1{image};
+      const auto num_instructions = cpu::convert<std::uint64_t>(args[i + 2]);
+
+      if (start && start->restore(control_unit1) != 0)
+      {
+         std::cout << "Checkpoint does not match the program image!\n";
+         return 1;
+      }
+
+      for (std::uint64_t j = 0; j < num_instructions; ++j)
+      {
+         if (j % 1024 == 0) control_unit1.data_mem().write(cpu::PINB, (j / 1024) % 2 ? (1 << cpu::program_memory::BUTTON1) : 0x00);
+         control_unit1.step();
+      }
+
+      control_unit1.usage.print();
+      return control_unit1.usage.save(args[i + 1]);
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--fleet")
+   {
+      const auto num_threads = args.size() >= i + 3 ? cpu::convert<std::size_t>(args[i + 2]) : 1;
+      const auto num_cycles = args.size() >= i + 4 ? cpu::convert<std::uint64_t>(args[i + 3]) : 16000000;
+
+      if (start && !start->matches(*image))
+      {
+         std::cout << "Checkpoint does not match the program image!\n";
+         return 1;
+      }
+
+      cpu::fleet fleet{image, cpu::convert<std::size_t>(args[i + 1]), num_cycles, start.get()};
+      fleet.run(num_threads > 0 ? num_threads : 1);
+      fleet.print();
+      return 0;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--profile")
+   {
+      cpu::control_unit<> control_unit1{image};
+      cpu::profile profile;
+      profile.record(control_unit1, cpu::convert<std::uint64_t>(args[i + 1]));
+      profile.print(*image);
+      return profile.save(cpu::profile::filename(image_filename));
+   }
+
+   if (args.size() >= i + 3 && args[i] == "--fleet-benchmark")
+   {
+      auto engine = cpu::engine::interpreter;
+      std::unique_ptr<cpu::specialized_engine<>> specialized;
+
+      if (args.size() >= i + 4 && args[i + 3] == "native") engine = cpu::engine::native;
+      else if (args.size() >= i + 4 && args[i + 3] == "specialized") engine = cpu::engine::specialized;
+
+      if (engine == cpu::engine::native && image->hash() != cpu::demo_native::IMAGE_HASH)
+      {
+         std::cout << "The native engine was generated from another program image!\n";
+         return 1;
+      }
+
+      if (engine == cpu::engine::specialized)
+      {
+         const auto profile = cpu::profile::load(*image, image_filename);
+
+         if (!profile)
+         {
+            std::cout << "No profile for the program image, record one with --profile!\n";
+            return 1;
+         }
+
+         specialized = std::make_unique<cpu::specialized_engine<>>(*image, *profile);
+         specialized->print();
+      }
+
+      cpu::fleet::benchmark(image, cpu::convert<std::size_t>(args[i + 1]),
+                            cpu::convert<std::size_t>(args[i + 2]), 16, engine, specialized.get());
+      return 0;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--check-engine")
+   {
+      const auto max_run_length = args.size() >= i + 3 ? cpu::convert<std::uint64_t>(args[i + 2]) : 4;
+      cpu::engine_check::runner execute = [](cpu::control_unit<>& unit, const std::uint64_t n) { cpu::demo_native::run(unit, n); };
+      std::unique_ptr<cpu::specialized_engine<>> specialized;
+
+      if (args.size() >= i + 4 && args[i + 3] == "specialized")
+      {
+         const auto profile = cpu::profile::load(*image, image_filename);
+
+         if (!profile)
+         {
+            std::cout << "No profile for the program image, record one with --profile!\n";
+            return 1;
+         }
+
+         specialized = std::make_unique<cpu::specialized_engine<>>(*image, *profile);
+         execute = [&specialized](cpu::control_unit<>& unit, const std::uint64_t n) { specialized->run(unit, n); };
+      }
+      else if (image->hash() != cpu::demo_native::IMAGE_HASH)
+      {
+         std::cout << "The native engine was generated from another program image!\n";
+         return 1;
+      }
+
+      cpu::engine_check check{image, execute, max_run_length > 0 ? max_run_length : 1};
+      check.run(cpu::convert<std::size_t>(args[i + 1]));
+      check.print();
+      return check.num_mismatches == 0 ? 0 : 1;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--explore")
+   {
+      const auto num_threads = args.size() >= i + 3 ? cpu::convert<std::size_t>(args[i + 2]) : 1;
+      const auto input_mask = args.size() >= i + 4 ? cpu::convert<int>(args[i + 3]) : (1 << cpu::program_memory::BUTTON1);
+      cpu::explorer explorer{image, static_cast<std::uint8_t>(input_mask)};
+      explorer.run(cpu::convert<std::size_t>(args[i + 1]), num_threads > 0 ? num_threads : 1);
+      explorer.print();
+      return explorer.violations.empty() ? 0 : 1;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--monitor")
+   {
+      const cpu::shared_snapshot snapshot{args[i + 1], false};
+      const auto interval = args.size() >= i + 3 ? cpu::convert<int>(args[i + 2]) : 1000;
+
+      if (!snapshot.is_open())
+      {
+         std::cout << "Could not open shared memory segment " << args[i + 1] << "!\n";
+         return 1;
+      }
+
+      snapshot.monitor(std::chrono::milliseconds(interval));
+      return 0;
+   }
+
+   cpu::control_unit<> control_unit1{image};
+   cpu::terminal<> terminal1{control_unit1};
+
+   if (start && start->restore(control_unit1) != 0)
+   {
+      std::cout << "Checkpoint does not match the program image!\n";
+      return 1;
+   }
+
+   if (args.size() >= i + 2 && args[i] == "--publish")
+   {
+      static cpu::shared_snapshot snapshot{args[i + 1], true};
+      terminal1.publisher = snapshot.lock;
+   }
+
+   terminal1.run_with_key_press();
    return 0;
 }
\ No newline at end of file
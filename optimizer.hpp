@@ -0,0 +1,300 @@
+#ifndef OPTIMIZER_HPP_
+#define OPTIMIZER_HPP_
+
+#include "program_image.hpp"
+#include "cpu.hpp"
+
+/* Offline peephole optimizer for program images. Instructions in the
+   interrupt vector table are never moved, so all vector addresses stay
+   the same, and every read and write of the I/O registers is kept. */
+struct cpu::optimizer
+{
+   struct report_entry
+   {
+      std::string name;
+      std::size_t before = 0;
+      std::size_t after = 0;
+   };
+
+   static constexpr auto NUM_REGISTERS = 32;
+
+   std::vector<program_image::instruction> code;
+   std::vector<bool> removed;
+   std::vector<report_entry> report;
+   std::size_t vector_table_end = 0;
+
+   static bool is_branch(const std::uint8_t op_code)
+   {
+      return op_code == JMP || op_code == CALL || (op_code >= BREQ && op_code <= BRLE);
+   }
+
+   static bool ends_flow(const std::uint8_t op_code)
+   {
+      return op_code == JMP || op_code == RET || op_code == RETI;
+   }
+
+   std::size_t next_kept(std::size_t address) const
+   {
+      while (address < code.size() && removed[address]) address++;
+      return address;
+   }
+
+   bool thread_jumps(void)
+   {
+      auto changed = false;
+
+      for (auto& i : code)
+      {
+         if (!is_branch(i.op_code)) continue;
+         auto target = next_kept(i.op1);
+
+         for (std::size_t hops = 0; hops < code.size() && target < code.size(); ++hops)
+         {
+            if (code[target].op_code != JMP || next_kept(code[target].op1) == target) break;
+            target = next_kept(code[target].op1);
+         }
+
+         if (target != i.op1)
+         {
+            i.op1 = target;
+            changed = true;
+         }
+      }
+      return changed;
+   }
+
+   bool fold_branches_to_return(void)
+   {
+      auto changed = false;
+
+      for (auto& i : code)
+      {
+         if (i.op_code != JMP || next_kept(i.op1) >= code.size()) continue;
+         const auto target = code[next_kept(i.op1)].op_code;
+
+         if (target == RET || target == RETI)
+         {
+            i = { target };
+            changed = true;
+         }
+      }
+      return changed;
+   }
+
+   std::vector<bool> leaders(void) const
+   {
+      std::vector<bool> leader(code.size() + 1, false);
+      leader[0] = true;
+
+      for (std::size_t i = 0; i < code.size(); ++i)
+      {
+         if (i < vector_table_end) leader[i] = true;
+         if (is_branch(code[i].op_code) && code[i].op1 < code.size()) leader[code[i].op1] = true;
+         if (is_branch(code[i].op_code) || ends_flow(code[i].op_code)) leader[i + 1] = true;
+      }
+      return leader;
+   }
+
+   bool propagate_constants(void)
+   {
+      const auto leader = leaders();
+      std::array<int, NUM_REGISTERS> known{};
+      auto changed = false;
+
+      for (std::size_t i = 0; i < code.size(); ++i)
+      {
+         if (leader[i]) known.fill(-1);
+         if (removed[i]) continue;
+         const auto& instruction = code[i];
+
+         if (instruction.op_code == LDI || instruction.op_code == CLR)
+         {
+            if (instruction.op1 >= NUM_REGISTERS) continue;
+            const auto value = instruction.op_code == LDI ? instruction.op2 : 0x00;
+
+            if (known[instruction.op1] == value && i >= vector_table_end)
+            {
+               removed[i] = true;
+               changed = true;
+            }
+            known[instruction.op1] = value;
+         }
+         else if (instruction.op_code == MOV && instruction.op1 < NUM_REGISTERS && instruction.op2 < NUM_REGISTERS)
+         {
+            known[instruction.op1] = known[instruction.op2];
+         }
+         else if (instruction.op_code == CALL)
+         {
+            known.fill(-1);
+         }
+         else if (writes_register(instruction.op_code))
+         {
+            if (instruction.op1 < NUM_REGISTERS) known[instruction.op1] = -1;
+            if (instruction.op_code == LDS && instruction.op1 + 1 < NUM_REGISTERS) known[instruction.op1 + 1] = -1;
+         }
+      }
+      return changed;
+   }
+
+   static bool writes_register(const std::uint8_t op_code)
+   {
+      return op_code == IN || op_code == LDS || op_code == POP ||
+         (op_code >= ORI && op_code <= SUB);
+   }
+
+   bool remove_jumps_to_next(void)
+   {
+      auto changed = false;
+
+      for (std::size_t i = vector_table_end; i < code.size(); ++i)
+      {
+         if (removed[i] || code[i].op_code != JMP) continue;
+
+         if (next_kept(i + 1) == next_kept(code[i].op1))
+         {
+            removed[i] = true;
+            changed = true;
+         }
+      }
+      return changed;
+   }
+
+   static std::uint8_t inverted_branch(const std::uint8_t op_code)
+   {
+      if (op_code == BREQ) return BRNE;
+      else if (op_code == BRNE) return BREQ;
+      else if (op_code == BRGT) return BRLE;
+      else if (op_code == BRLE) return BRGT;
+      else return NOP;
+   }
+
+   bool is_target(const std::size_t address) const
+   {
+      for (std::size_t i = 0; i < code.size(); ++i)
+      {
+         if (!removed[i] && is_branch(code[i].op_code) && next_kept(code[i].op1) == address) return true;
+      }
+      return false;
+   }
+
+   bool invert_branches_over_jumps(void)
+   {
+      auto changed = false;
+
+      for (std::size_t i = vector_table_end; i < code.size(); ++i)
+      {
+         const auto op_code = inverted_branch(code[i].op_code);
+         if (removed[i] || op_code == NOP) continue;
+         const auto jump = next_kept(i + 1);
+
+         if (jump >= code.size() || code[jump].op_code != JMP || is_target(jump)) continue;
+
+         if (next_kept(jump + 1) == next_kept(code[i].op1))
+         {
+            code[i] = { op_code, code[jump].op1 };
+            removed[jump] = true;
+            changed = true;
+         }
+      }
+      return changed;
+   }
+
+   bool remove_unreachable(void)
+   {
+      std::vector<bool> reachable(code.size(), false);
+      std::vector<std::size_t> pending;
+      auto changed = false;
+
+      for (std::size_t i = 0; i < vector_table_end && i < code.size(); ++i)
+      {
+         pending.push_back(i);
+      }
+
+      while (!pending.empty())
+      {
+         const auto address = next_kept(pending.back());
+         pending.pop_back();
+         if (address >= code.size() || reachable[address]) continue;
+         reachable[address] = true;
+
+         const auto& instruction = code[address];
+         if (is_branch(instruction.op_code)) pending.push_back(instruction.op1);
+         if (!ends_flow(instruction.op_code)) pending.push_back(address + 1);
+      }
+
+      for (std::size_t i = vector_table_end; i < code.size(); ++i)
+      {
+         if (!reachable[i] && !removed[i])
+         {
+            removed[i] = true;
+            changed = true;
+         }
+      }
+      return changed;
+   }
+
+   std::shared_ptr<const program_image> optimize(const program_image& image,
+                                                 const std::size_t vector_table_end = program_memory::ISR_vect_end)
+   {
+      code = image.decoded;
+      removed.assign(code.size(), false);
+      this->vector_table_end = vector_table_end;
+
+      for (auto changed = true; changed;)
+      {
+         changed = thread_jumps();
+         changed |= fold_branches_to_return();
+         changed |= propagate_constants();
+         changed |= remove_jumps_to_next();
+         changed |= invert_branches_over_jumps();
+         changed |= remove_unreachable();
+      }
+
+      std::vector<std::uint8_t> new_address(code.size() + 1, 0);
+      std::vector<std::uint32_t> data;
+      std::uint8_t num_kept = 0;
+
+      for (std::size_t i = 0; i <= code.size(); ++i)
+      {
+         new_address[i] = num_kept;
+         if (i < code.size() && !removed[i]) num_kept++;
+      }
+
+      for (std::size_t i = 0; i < code.size(); ++i)
+      {
+         if (removed[i]) continue;
+         auto instruction = code[i];
+         if (is_branch(instruction.op_code) && instruction.op1 < code.size()) instruction.op1 = new_address[instruction.op1];
+         data.push_back(program_memory::assemble(instruction.op_code, instruction.op1, instruction.op2));
+      }
+
+      std::vector<program_image::symbol> symbols;
+      report.clear();
+
+      for (const auto& i : image.symbols)
+      {
+         const auto address = new_address[std::min<std::size_t>(i.address, code.size())];
+         const auto end = new_address[std::min<std::size_t>(i.end, code.size())];
+         symbols.push_back({ address, end, i.name });
+         report.push_back({ i.name, static_cast<std::size_t>(i.end - i.address), static_cast<std::size_t>(end - address) });
+      }
+
+      report.push_back({ "Total", image.address_width(), data.size() });
+      return std::make_shared<const program_image>(std::move(data), std::move(symbols));
+   }
+
+   void print_report(std::ostream& ostream = std::cout) const
+   {
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Instruction count before and after optimization:\n\n";
+
+      for (const auto& i : report)
+      {
+         ostream << std::left << std::setw(24) << i.name + ":" << i.before << " -> " << i.after << "\n";
+      }
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* OPTIMIZER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,340 @@
+#ifndef PERF_COUNTERS_HPP_
+#define PERF_COUNTERS_HPP_
+
+#include "cpu.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+/* Host hardware performance counters, opened as one group with
+   perf_event_open so that all counters are read with a single syscall.
+   Counters that can't be opened (e.g. in containers or on other platforms)
+   are left out, and the measurement falls back to wall clock time only. */
+struct cpu::perf_counters
+{
+   enum counter
+   {
+      host_cycles,
+      host_instructions,
+      branch_misses,
+      l1d_misses,
+      llc_misses,
+      NUM_COUNTERS
+   };
+
+   using values = std::array<std::uint64_t, NUM_COUNTERS>;
+
+   std::array<int, NUM_COUNTERS> fd{ -1, -1, -1, -1, -1 };
+   std::vector<counter> group;
+   std::string error;
+
+   static const char* counter_name(const counter counter)
+   {
+      if (counter == host_cycles) return "Host cycles";
+      else if (counter == host_instructions) return "Host instructions";
+      else if (counter == branch_misses) return "Branch misses";
+      else if (counter == l1d_misses) return "L1D read misses";
+      else if (counter == llc_misses) return "LLC misses";
+      else return "Unknown";
+   }
+
+   perf_counters(void)
+   {
+#ifdef __linux__
+      for (auto i = 0; i < NUM_COUNTERS; ++i)
+      {
+         perf_event_attr attr{};
+         attr.size = sizeof(attr);
+         attr.exclude_kernel = 1;
+         attr.exclude_hv = 1;
+         attr.read_format = PERF_FORMAT_GROUP;
+         attr.disabled = group.empty();
+         set_event(attr, static_cast<counter>(i));
+
+         const auto group_fd = group.empty() ? -1 : fd[group.front()];
+         fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+
+         if (fd[i] >= 0)
+         {
+            group.push_back(static_cast<counter>(i));
+         }
+         else if (error.empty())
+         {
+            error = std::strerror(errno);
+         }
+      }
+
+      if (!group.empty())
+      {
+         ioctl(fd[group.front()], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+         ioctl(fd[group.front()], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+#else
+      error = "perf_event_open is only supported on Linux";
+#endif
+      return;
+   }
+
+   ~perf_counters(void)
+   {
+#ifdef __linux__
+      for (const auto& i : fd)
+      {
+         if (i >= 0) close(i);
+      }
+#endif
+      return;
+   }
+
+   perf_counters(const perf_counters&) = delete;
+   perf_counters& operator=(const perf_counters&) = delete;
+
+#ifdef __linux__
+   static void set_event(perf_event_attr& attr, const counter counter)
+   {
+      static constexpr auto l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+         (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+      attr.type = counter == l1d_misses ? PERF_TYPE_HW_CACHE : PERF_TYPE_HARDWARE;
+
+      if (counter == host_cycles) attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      else if (counter == host_instructions) attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      else if (counter == branch_misses) attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      else if (counter == l1d_misses) attr.config = l1d_read_miss;
+      else if (counter == llc_misses) attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      return;
+   }
+#endif
+
+   bool available(void) const
+   {
+      return !group.empty();
+   }
+
+   bool available(const counter counter) const
+   {
+      return fd[counter] >= 0;
+   }
+
+   values read(void) const
+   {
+      values result{};
+#ifdef __linux__
+      if (group.empty()) return result;
+      std::array<std::uint64_t, NUM_COUNTERS + 1> buffer{};
+
+      if (::read(fd[group.front()], buffer.data(), sizeof(buffer)) > 0)
+      {
+         for (std::size_t i = 0; i < group.size() && i < buffer[0]; ++i)
+         {
+            result[group[i]] = buffer[i + 1];
+         }
+      }
+#endif
+      return result;
+   }
+
+   static values difference(const values& end, const values& start)
+   {
+      values result{};
+
+      for (std::size_t i = 0; i < result.size(); ++i)
+      {
+         result[i] = end[i] > start[i] ? end[i] - start[i] : 0;
+      }
+      return result;
+   }
+};
+
+/* Host counters per simulated instruction, in total and per opcode class.
+   The total is accumulated from counter reads around batches of
+   instructions run by an execution engine, which also gives the spread
+   between batches. Per class figures read the counters around every single
+   instruction of the interpreter. The cost of an empty measurement is
+   subtracted from both. */
+struct cpu::perf_report
+{
+   struct entry
+   {
+      std::uint64_t num_instructions = 0;
+      perf_counters::values total{};
+   };
+
+   entry overall;
+   std::array<entry, NUM_OPCODE_CLASSES> by_class{};
+   engine execution_engine = engine::interpreter;
+   std::uint64_t batch_size = 0;
+   std::size_t num_batches = 0;
+   std::array<double, perf_counters::NUM_COUNTERS> batch_min{};
+   std::array<double, perf_counters::NUM_COUNTERS> batch_max{};
+   double wall_time = 0.0;
+   std::string error;
+   std::vector<perf_counters::counter> available;
+
+   template<class control_unit_type>
+   void measure(control_unit_type& control_unit,
+                const std::uint64_t num_instructions,
+                const std::uint64_t batch_size = 1000)
+   {
+      const auto interpret = [](control_unit_type& unit, const std::uint64_t n)
+      {
+         for (std::uint64_t i = 0; i < n; ++i)
+         {
+            unit.step();
+         }
+      };
+
+      measure(control_unit, num_instructions, interpret, engine::interpreter, batch_size);
+      return;
+   }
+
+   template<class control_unit_type, class runner>
+   void measure(control_unit_type& control_unit,
+                const std::uint64_t num_instructions,
+                const runner& run,
+                const engine execution_engine,
+                const std::uint64_t batch_size = 1000)
+   {
+      perf_counters counters;
+      error = counters.error;
+      available = counters.group;
+      this->execution_engine = execution_engine;
+      this->batch_size = batch_size > 0 ? batch_size : 1;
+
+      const auto overhead = counters.available() ? calibrate(counters) : perf_counters::values{};
+      const auto first_instruction = control_unit.core.num_instructions;
+      batch_min.fill(std::numeric_limits<double>::max());
+      batch_max.fill(0.0);
+
+      const auto start_time = std::chrono::steady_clock::now();
+
+      while (control_unit.core.num_instructions - first_instruction < num_instructions)
+      {
+         const auto remaining = num_instructions - (control_unit.core.num_instructions - first_instruction);
+         const auto batch_start = control_unit.core.num_instructions;
+         const auto before = counters.read();
+         run(control_unit, std::min(this->batch_size, remaining));
+         const auto after = counters.read();
+
+         const auto batch_instructions = control_unit.core.num_instructions - batch_start;
+         if (batch_instructions == 0) break;
+
+         const auto delta = perf_counters::difference(perf_counters::difference(after, before), overhead);
+         num_batches++;
+
+         for (std::size_t j = 0; j < delta.size(); ++j)
+         {
+            const auto per_instruction = static_cast<double>(delta[j]) / batch_instructions;
+            overall.total[j] += delta[j];
+            batch_min[j] = std::min(batch_min[j], per_instruction);
+            batch_max[j] = std::max(batch_max[j], per_instruction);
+         }
+      }
+
+      overall.num_instructions = control_unit.core.num_instructions - first_instruction;
+      wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+      if (!counters.available() || execution_engine != engine::interpreter) return;
+
+      for (std::uint64_t i = 0; i < num_instructions; ++i)
+      {
+         const auto op_code = control_unit.next_op_code();
+         const auto before = counters.read();
+         control_unit.step();
+         const auto after = counters.read();
+
+         auto& entry = by_class[static_cast<std::size_t>(classify(op_code))];
+         const auto delta = perf_counters::difference(perf_counters::difference(after, before), overhead);
+         entry.num_instructions++;
+
+         for (std::size_t j = 0; j < delta.size(); ++j)
+         {
+            entry.total[j] += delta[j];
+         }
+      }
+      return;
+   }
+
+   static perf_counters::values calibrate(const perf_counters& counters,
+                                          const std::size_t num_samples = 1000)
+   {
+      perf_counters::values overhead{};
+      overhead.fill(UINT64_MAX);
+
+      for (std::size_t i = 0; i < num_samples; ++i)
+      {
+         const auto before = counters.read();
+         const auto delta = perf_counters::difference(counters.read(), before);
+
+         for (std::size_t j = 0; j < delta.size(); ++j)
+         {
+            if (delta[j] < overhead[j]) overhead[j] = delta[j];
+         }
+      }
+      return overhead;
+   }
+
+   void print_entry(const char* name,
+                    const entry& entry,
+                    std::ostream& ostream) const
+   {
+      ostream << name << " (" << entry.num_instructions << " instructions):\n";
+      if (entry.num_instructions == 0) return;
+
+      for (const auto& i : available)
+      {
+         ostream << "   " << std::left << std::setw(24) << std::string(perf_counters::counter_name(i)) + ":"
+                 << static_cast<double>(entry.total[i]) / entry.num_instructions << " per instruction\n";
+      }
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Execution engine:\t\t\t\t" << engine_name(execution_engine) << "\n";
+      ostream << "Simulated instructions:\t\t\t\t" << overall.num_instructions << "\n";
+      ostream << "Wall clock time:\t\t\t\t" << wall_time << " s\n";
+      ostream << "Simulated instructions per second:\t\t" << (wall_time > 0 ? overall.num_instructions / wall_time : 0.0) << "\n\n";
+
+      if (available.empty())
+      {
+         ostream << "Hardware performance counters not available: " << error << "\n";
+         ostream << "--------------------------------------------------------------------------------\n\n";
+         return;
+      }
+
+      print_entry("All instructions", overall, ostream);
+      ostream << "\nSpread over " << num_batches << " batches of " << batch_size << " instructions:\n";
+
+      for (const auto& i : available)
+      {
+         ostream << "   " << std::left << std::setw(24) << std::string(perf_counters::counter_name(i)) + ":"
+                 << batch_min[i] << " - " << batch_max[i] << " per instruction\n";
+      }
+
+      if (execution_engine != engine::interpreter)
+      {
+         ostream << "\nPer opcode class figures are only measured with the interpreter.\n";
+      }
+      else
+      {
+         ostream << "\nPer opcode class (measurement overhead subtracted):\n";
+
+         for (auto i = 0; i < NUM_OPCODE_CLASSES; ++i)
+         {
+            print_entry(opcode_class_name(static_cast<opcode_class>(i)), by_class[i], ostream);
+         }
+      }
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* PERF_COUNTERS_HPP_ */
\ No newline at end of file
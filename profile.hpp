@@ -0,0 +1,185 @@
+#ifndef PROFILE_HPP_
+#define PROFILE_HPP_
+
+#include "program_image.hpp"
+#include "recompiler.hpp"
+#include "cpu.hpp"
+
+/* Execution profile of a program image, recorded in a training run with
+   the interpreter. Opcode frequencies, execution counts per address and
+   taken branches per address are counted, hot ranges are reported per
+   basic block, and the profile is saved next to the program image for the
+   specialized engine to be built from. Each step is recorded from the
+   instruction at the program counter before the step, since RETI and
+   interrupt entries replace the decoded instruction of the core. */
+struct cpu::profile
+{
+   static constexpr std::uint32_t MAGIC = 0x464F5250; /* "PROF" */
+   static constexpr std::size_t NUM_ADDRESSES = 256;
+
+   struct range
+   {
+      std::uint8_t address = 0x00;
+      std::uint8_t end = 0x00;
+      std::uint64_t count = 0;
+   };
+
+   std::uint64_t image_hash = 0;
+   std::uint64_t num_instructions = 0;
+   std::array<std::uint64_t, NUM_ADDRESSES> opcode_counts{};
+   std::array<std::uint64_t, NUM_ADDRESSES> address_counts{};
+   std::array<std::uint64_t, NUM_ADDRESSES> taken_counts{};
+
+   profile(const std::uint64_t image_hash = 0)
+      : image_hash{image_hash} { }
+
+   static std::string filename(const std::string& image_filename)
+   {
+      return image_filename + ".profile";
+   }
+
+   template<class control_unit_type>
+   void record(control_unit_type& unit, const std::uint64_t num_steps)
+   {
+      image_hash = unit.prog_mem.image->hash();
+
+      for (std::uint64_t i = 0; i < num_steps; ++i)
+      {
+         if (i % 1024 == 0) unit.data_mem().write(PINB, (i / 1024) % 2 ? (1 << program_memory::BUTTON1) : 0x00);
+
+         const auto address = unit.core.current_state == state::fetch ? unit.core.pc : unit.core.mar;
+         const auto op_code = unit.next_op_code();
+         const auto taken = branch_taken(unit, op_code);
+         unit.step();
+
+         opcode_counts[op_code]++;
+         address_counts[address]++;
+         num_instructions++;
+         if (taken) taken_counts[address]++;
+      }
+      return;
+   }
+
+   template<class control_unit_type>
+   static bool branch_taken(const control_unit_type& unit, const std::uint8_t op_code)
+   {
+      if (op_code == BREQ) return unit.equal();
+      else if (op_code == BRNE) return !unit.equal();
+      else if (op_code == BRGE) return unit.greater() || unit.equal();
+      else if (op_code == BRGT) return unit.greater();
+      else if (op_code == BRLE) return unit.lower() || unit.equal();
+      else if (op_code == BRLT) return unit.lower();
+      else return false;
+   }
+
+   double taken_ratio(const std::uint8_t address) const
+   {
+      return address_counts[address] > 0 ? static_cast<double>(taken_counts[address]) / address_counts[address] : 0.0;
+   }
+
+   std::vector<range> hot_ranges(const program_image& image) const
+   {
+      const recompiler blocks{image};
+      std::vector<range> ranges;
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         if (blocks.leaders[i] || ranges.empty())
+         {
+            ranges.push_back({ static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i), 0 });
+         }
+
+         ranges.back().end++;
+         ranges.back().count += address_counts[i];
+      }
+
+      std::erase_if(ranges, [](const range& i) { return i.count == 0; });
+
+      std::stable_sort(ranges.begin(), ranges.end(), [](const range& a, const range& b) { return a.count > b.count; });
+      return ranges;
+   }
+
+   int save(const std::string& filename) const
+   {
+      std::ofstream file(filename, std::ios::binary);
+      if (!file) return 1;
+
+      program_image::write_value(file, MAGIC);
+      program_image::write_value(file, image_hash);
+      program_image::write_value(file, num_instructions);
+      program_image::write_value(file, opcode_counts);
+      program_image::write_value(file, address_counts);
+      program_image::write_value(file, taken_counts);
+      return file ? 0 : 1;
+   }
+
+   static std::unique_ptr<profile> load(const std::string& filename)
+   {
+      std::ifstream file(filename, std::ios::binary);
+      auto loaded = std::make_unique<profile>();
+      std::uint32_t magic = 0;
+
+      if (!program_image::read_value(file, magic) || magic != MAGIC) return nullptr;
+      if (!program_image::read_value(file, loaded->image_hash)) return nullptr;
+      if (!program_image::read_value(file, loaded->num_instructions)) return nullptr;
+      if (!program_image::read_value(file, loaded->opcode_counts)) return nullptr;
+      if (!program_image::read_value(file, loaded->address_counts)) return nullptr;
+      if (!program_image::read_value(file, loaded->taken_counts)) return nullptr;
+      return loaded;
+   }
+
+   static std::unique_ptr<profile> load(const program_image& image, const std::string& image_filename)
+   {
+      auto loaded = load(filename(image_filename));
+      return loaded && loaded->image_hash == image.hash() ? std::move(loaded) : nullptr;
+   }
+
+   void print(const program_image& image, std::ostream& ostream = std::cout) const
+   {
+      std::vector<std::uint8_t> op_codes;
+
+      for (std::size_t i = 0; i < NUM_ADDRESSES; ++i)
+      {
+         if (opcode_counts[i]) op_codes.push_back(static_cast<std::uint8_t>(i));
+      }
+
+      std::stable_sort(op_codes.begin(), op_codes.end(), [this](const std::uint8_t a, const std::uint8_t b)
+      {
+         return opcode_counts[a] > opcode_counts[b];
+      });
+
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Profiled instructions:\t\t\t\t" << num_instructions << "\n\n";
+
+      for (const auto i : op_codes)
+      {
+         ostream << instruction_name(i) << ":\t\t\t\t\t\t" << std::fixed << std::setprecision(1)
+                 << 100.0 * opcode_counts[i] / num_instructions << " %\n";
+      }
+      ostream << "\n";
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         const auto instruction = image.read_decoded(static_cast<std::uint32_t>(i));
+
+         if (instruction.op_code >= BREQ && instruction.op_code <= BRLE && address_counts[i])
+         {
+            ostream << "Branch taken at address " << i << " (" << instruction_name(instruction.op_code) << "):\t\t"
+                    << 100.0 * taken_ratio(static_cast<std::uint8_t>(i)) << " %\n";
+         }
+      }
+      ostream << "\n";
+
+      for (const auto& i : hot_ranges(image))
+      {
+         ostream << "Hot range " << static_cast<int>(i.address) << "-" << static_cast<int>(i.end - 1)
+                 << " (" << image.subroutine_name(i.address) << "):\t\t" << 100.0 * i.count / num_instructions << " %\n";
+      }
+
+      ostream << std::defaultfloat << std::setprecision(6);
+      ostream << "--------------------------------------------------------------------------------\n\n";
+      return;
+   }
+};
+
+#endif /* PROFILE_HPP_ */
\ No newline at end of file
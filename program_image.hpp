@@ -0,0 +1,220 @@
+#ifndef PROGRAM_IMAGE_HPP_
+#define PROGRAM_IMAGE_HPP_
+
+#include "cpu.hpp"
+
+/* Immutable program, shared between all control units running the same
+   firmware. The pre-decoded instructions and the symbols are stored once. */
+struct cpu::program_image
+{
+   struct instruction
+   {
+      std::uint8_t op_code = NOP;
+      std::uint8_t op1 = 0x00;
+      std::uint8_t op2 = 0x00;
+   };
+
+   struct symbol
+   {
+      std::uint8_t address = 0x00;
+      std::uint8_t end = 0x00;
+      std::string name;
+   };
+
+   static constexpr std::uint32_t MAGIC = 0x474D4943; /* "CIMG" */
+   static constexpr std::uint32_t MAX_ADDRESS_WIDTH = 256;
+   static constexpr auto NUM_REGISTERS = 32;
+   static constexpr std::size_t SYMBOL_HEADER_SIZE = 2 * sizeof(std::uint8_t) + sizeof(std::uint32_t);
+
+   const std::vector<std::uint32_t> data;
+   const std::vector<instruction> decoded;
+   const std::vector<symbol> symbols;
+
+   program_image(std::vector<std::uint32_t> data,
+                 std::vector<symbol> symbols = {})
+      : data{std::move(data)}
+      , decoded{decode_all(this->data)}
+      , symbols{std::move(symbols)} { }
+
+   static instruction decode(const std::uint32_t ir)
+   {
+      return { static_cast<std::uint8_t>(ir >> 16),
+               static_cast<std::uint8_t>(ir >> 8),
+               static_cast<std::uint8_t>(ir) };
+   }
+
+   static std::vector<instruction> decode_all(const std::vector<std::uint32_t>& data)
+   {
+      std::vector<instruction> decoded;
+      decoded.reserve(data.size());
+
+      for (const auto& i : data)
+      {
+         decoded.push_back(decode(i));
+      }
+      return decoded;
+   }
+
+   static bool valid(const instruction& instruction)
+   {
+      const auto op_code = instruction.op_code;
+
+      if (op_code == STS)
+      {
+         return instruction.op2 < NUM_REGISTERS - 1;
+      }
+      else if (op_code == LDS)
+      {
+         return instruction.op1 < NUM_REGISTERS - 1;
+      }
+      else if (op_code == OUT)
+      {
+         return instruction.op2 < NUM_REGISTERS;
+      }
+      else if (op_code == MOV || op_code == OR || op_code == AND || op_code == XOR ||
+               op_code == ADD || op_code == SUB || op_code == CP)
+      {
+         return instruction.op1 < NUM_REGISTERS && instruction.op2 < NUM_REGISTERS;
+      }
+      else if (op_code == LDI || op_code == IN || op_code == ORI || op_code == ANDI || op_code == XORI ||
+               op_code == CLR || op_code == INC || op_code == DEC || op_code == ADDI || op_code == SUBI ||
+               op_code == CPI || op_code == PUSH || op_code == POP)
+      {
+         return instruction.op1 < NUM_REGISTERS;
+      }
+      else
+      {
+         return true;
+      }
+   }
+
+   std::size_t address_width(void) const
+   {
+      return data.size();
+   }
+
+   std::uint32_t read(const std::uint32_t address) const
+   {
+      if (address < address_width())
+      {
+         return data[address];
+      }
+      else
+      {
+         return 0;
+      }
+   }
+
+   instruction read_decoded(const std::uint32_t address) const
+   {
+      if (address < address_width())
+      {
+         return decoded[address];
+      }
+      else
+      {
+         return instruction{};
+      }
+   }
+
+   std::uint64_t hash(void) const
+   {
+      std::uint64_t hash = 0xCBF29CE484222325;
+
+      for (const auto& i : data)
+      {
+         for (auto j = 0; j < 4; ++j)
+         {
+            hash = (hash ^ ((i >> (8 * j)) & 0xFF)) * 0x100000001B3;
+         }
+      }
+      return hash;
+   }
+
+   int save(const std::string& filename) const
+   {
+      std::ofstream file(filename, std::ios::binary);
+      if (!file) return 1;
+
+      write_value(file, MAGIC);
+      write_value(file, static_cast<std::uint32_t>(data.size()));
+
+      for (const auto& i : data)
+      {
+         write_value(file, i);
+      }
+
+      write_value(file, static_cast<std::uint32_t>(symbols.size()));
+
+      for (const auto& i : symbols)
+      {
+         write_value(file, i.address);
+         write_value(file, i.end);
+         write_value(file, static_cast<std::uint32_t>(i.name.size()));
+         file.write(i.name.data(), i.name.size());
+      }
+      return file ? 0 : 1;
+   }
+
+   static std::shared_ptr<const program_image> load(const std::string& filename)
+   {
+      std::ifstream file(filename, std::ios::binary);
+      std::uint32_t magic = 0, size = 0;
+
+      if (!read_value(file, magic) || magic != MAGIC) return nullptr;
+      if (!read_value(file, size) || size > MAX_ADDRESS_WIDTH) return nullptr;
+      std::vector<std::uint32_t> data(size);
+
+      for (auto& i : data)
+      {
+         if (!read_value(file, i) || !valid(decode(i))) return nullptr;
+      }
+
+      if (!read_value(file, size) || size > remaining(file) / SYMBOL_HEADER_SIZE) return nullptr;
+      std::vector<symbol> symbols(size);
+
+      for (auto& i : symbols)
+      {
+         std::uint32_t name_size = 0;
+         if (!read_value(file, i.address) || !read_value(file, i.end) || !read_value(file, name_size)) return nullptr;
+         if (name_size > remaining(file)) return nullptr;
+         i.name.resize(name_size);
+         if (!file.read(i.name.data(), name_size)) return nullptr;
+      }
+
+      return std::make_shared<const program_image>(std::move(data), std::move(symbols));
+   }
+
+   static std::size_t remaining(std::istream& istream)
+   {
+      const auto position = istream.tellg();
+      istream.seekg(0, std::ios::end);
+      const auto end = istream.tellg();
+      istream.seekg(position);
+      return position >= 0 && end >= position ? static_cast<std::size_t>(end - position) : 0;
+   }
+
+   template<class T>
+   static void write_value(std::ostream& ostream, const T& value)
+   {
+      ostream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+      return;
+   }
+
+   template<class T>
+   static bool read_value(std::istream& istream, T& value)
+   {
+      return static_cast<bool>(istream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+   }
+
+   const char* subroutine_name(const std::uint8_t address) const
+   {
+      for (const auto& i : symbols)
+      {
+         if (address >= i.address && address < i.end) return i.name.c_str();
+      }
+      return "Unknown";
+   }
+};
+
+#endif /* PROGRAM_IMAGE_HPP_ */
\ No newline at end of file
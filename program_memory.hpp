@@ -1,6 +1,7 @@
 #ifndef PROGRAM_MEMORY_HPP_
 #define PROGRAM_MEMORY_HPP_
 
+#include "program_image.hpp"
 #include "cpu.hpp"
 
 struct cpu::program_memory
@@ -43,106 +44,126 @@ struct cpu::program_memory
       return instruction;
    }
 
-   const std::vector<std::uint32_t> data =
+   static std::shared_ptr<const program_image> demo_image(void)
    {
-      /* RESET_vect: */
-      assemble(JMP, main),                 /* JMP main */
-      assemble(NOP),                       /* NOP */
-
-      /* PCINT0_vect: */
-      assemble(JMP, ISR_PCINT0),           /* JMP ISR_PCINT0 */
-      assemble(NOP),                       /* NOP */
-
-      /* ISR_PCINT0: */
-      assemble(CALL, button_is_pressed),   /* CALL button_is_pressed */
-      assemble(CPI, R24, 0x00),            /* CPI R24, 0x00 */
-      assemble(BREQ, ISR_PCINT0_end),      /* BRNE ISR_PCINT0_end */
-      assemble(CALL, led_toggle),          /* CALL led_toggle */
-      /* ISR_PCINT0_end: */
-      assemble(RETI),                      /* RETI */
-
-      /* main: */
-      assemble(CALL, setup),               /* CALL setup */
-      /* main_loop: */ 
-      assemble(JMP, main_loop),            /* JMP main_loop */
-
-      /* led_toggle: */
-      assemble(LDS, R16, led_enabled),     /* LDS R16, led_enabled */
-      assemble(CPI, R16, 0x00),            /* CPI R16, 0x00 */
-      assemble(BREQ, led_on),              /* BREQ led_on */
-      assemble(JMP, led_off),              /* JMP led_off */
-      /* led_toggle_end: */
-      assemble(RET),                       /* RET */
-
-      /* led_on: */
-      assemble(IN, R16, PORTB),            /* IN R16, PORTB */
-      assemble(ORI, R16, (1 << LED1)),     /* ORI R16, (1 << LED1) */
-      assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
-      assemble(LDI, R16, 0x01),            /* LDI R16, 0x01 */
-      assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
-      assemble(JMP, led_toggle_end),       /* JMP_led_toggle_end */
-
-      /* led_off: */
-      assemble(IN, R16, PORTB),            /* IN R16, PORTB */
-      assemble(ANDI, R16, ~(1 << LED1)),   /* ANDI R16, ~(1 << LED1) */
-      assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
-      assemble(LDI, R16, 0x00),            /* LDI R16, 0x00 */
-      assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
-      assemble(JMP, led_toggle_end),       /* JMP_led_toggle_end */
-
-      /* setup: */
-      assemble(LDI, R16, (1 << LED1)),     /* LDI R16, (1 << LED1) */
-      assemble(OUT, DDRB, R16),            /* OUT DDRB, R16 */
-      assemble(LDI, R16, (1 << BUTTON1)),  /* LDI R16, (1 << BUTTON1) */
-      assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
-      /* init_interrupts: */
-      assemble(SEI),                       /* SEI */
-      assemble(LDI, R16, (1 << PCIE0)),    /* LDI R16, (1 << PCIE0) */
-      assemble(OUT, PCICR, R16),           /* OUT PCICR, R16 */
-      assemble(LDI, R16, (1 << BUTTON1)),  /* LDI R16, (1 << BUTTON1) */
-      assemble(OUT, PCMSK0, R16),          /* OUT PCMSK0, R16 */
-      /* init_globals: */
-      assemble(CLR, R16),                  /* CLR R16 */
-      assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
-      assemble(RET),                       /* RET */
-
-      /* button_is_pressed: */
-      assemble(IN, R24, PINB),             /* IN R16, PINB */
-      assemble(ANDI, R24, (1 << BUTTON1)), /* ANDI R24, (1 << BUTTON1) */
-      assemble(RET)                        /* RET */
-   };
-
-   program_memory(void) { }
+      static const auto image = std::make_shared<const program_image>(demo_firmware(), demo_symbols());
+      return image;
+   }
 
-   std::size_t address_width(void) const
+   static std::vector<std::uint32_t> demo_firmware(void)
    {
-      return data.size();
+      return
+      {
+         /* RESET_vect: */
+         assemble(JMP, main),                 /* JMP main */
+         assemble(NOP),                       /* NOP */
+
+         /* PCINT0_vect: */
+         assemble(JMP, ISR_PCINT0),           /* JMP ISR_PCINT0 */
+         assemble(NOP),                       /* NOP */
+
+         /* ISR_PCINT0: */
+         assemble(CALL, button_is_pressed),   /* CALL button_is_pressed */
+         assemble(CPI, R24, 0x00),            /* CPI R24, 0x00 */
+         assemble(BREQ, ISR_PCINT0_end),      /* BRNE ISR_PCINT0_end */
+         assemble(CALL, led_toggle),          /* CALL led_toggle */
+         /* ISR_PCINT0_end: */
+         assemble(RETI),                      /* RETI */
+
+         /* main: */
+         assemble(CALL, setup),               /* CALL setup */
+         /* main_loop: */ 
+         assemble(JMP, main_loop),            /* JMP main_loop */
+
+         /* led_toggle: */
+         assemble(LDS, R16, led_enabled),     /* LDS R16, led_enabled */
+         assemble(CPI, R16, 0x00),            /* CPI R16, 0x00 */
+         assemble(BREQ, led_on),              /* BREQ led_on */
+         assemble(JMP, led_off),              /* JMP led_off */
+         /* led_toggle_end: */
+         assemble(RET),                       /* RET */
+
+         /* led_on: */
+         assemble(IN, R16, PORTB),            /* IN R16, PORTB */
+         assemble(ORI, R16, (1 << LED1)),     /* ORI R16, (1 << LED1) */
+         assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
+         assemble(LDI, R16, 0x01),            /* LDI R16, 0x01 */
+         assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
+         assemble(JMP, led_toggle_end),       /* JMP_led_toggle_end */
+
+         /* led_off: */
+         assemble(IN, R16, PORTB),            /* IN R16, PORTB */
+         assemble(ANDI, R16, ~(1 << LED1)),   /* ANDI R16, ~(1 << LED1) */
+         assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
+         assemble(LDI, R16, 0x00),            /* LDI R16, 0x00 */
+         assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
+         assemble(JMP, led_toggle_end),       /* JMP_led_toggle_end */
+
+         /* setup: */
+         assemble(LDI, R16, (1 << LED1)),     /* LDI R16, (1 << LED1) */
+         assemble(OUT, DDRB, R16),            /* OUT DDRB, R16 */
+         assemble(LDI, R16, (1 << BUTTON1)),  /* LDI R16, (1 << BUTTON1) */
+         assemble(OUT, PORTB, R16),           /* OUT PORTB, R16 */
+         /* init_interrupts: */
+         assemble(SEI),                       /* SEI */
+         assemble(LDI, R16, (1 << PCIE0)),    /* LDI R16, (1 << PCIE0) */
+         assemble(OUT, PCICR, R16),           /* OUT PCICR, R16 */
+         assemble(LDI, R16, (1 << BUTTON1)),  /* LDI R16, (1 << BUTTON1) */
+         assemble(OUT, PCMSK0, R16),          /* OUT PCMSK0, R16 */
+         /* init_globals: */
+         assemble(CLR, R16),                  /* CLR R16 */
+         assemble(STS, led_enabled, R16),     /* STS led_enabled, R16 */
+         assemble(RET),                       /* RET */
+
+         /* button_is_pressed: */
+         assemble(IN, R24, PINB),             /* IN R16, PINB */
+         assemble(ANDI, R24, (1 << BUTTON1)), /* ANDI R24, (1 << BUTTON1) */
+         assemble(RET)                        /* RET */
+      };
    }
 
-   std::uint32_t read(const std::uint32_t address)
+   static std::vector<program_image::symbol> demo_symbols(void)
    {
-      if (address < address_width())
+      return
       {
-         return data[address];
-      }
-      else
-      {
-         return 0;
-      }
+         { RESET_vect, RESET_vect + 1, "RESET_vect" },
+         { PCINT0_vect, PCINT0_vect + 1, "PCINT0_vect" },
+         { ISR_PCINT0, main, "ISR (PCINT0_vect)" },
+         { main, led_toggle, "main" },
+         { led_toggle, led_on, "led_toggle" },
+         { led_on, led_off, "led_on" },
+         { led_off, setup, "led_off" },
+         { setup, button_is_pressed, "setup" },
+         { button_is_pressed, end, "button_is_pressed" }
+      };
+   }
+
+   std::shared_ptr<const program_image> image;
+
+   program_memory(void)
+      : image{demo_image()} { }
+
+   program_memory(std::shared_ptr<const program_image> image)
+      : image{std::move(image)} { }
+
+   std::size_t address_width(void) const
+   {
+      return image->address_width();
+   }
+
+   std::uint32_t read(const std::uint32_t address) const
+   {
+      return image->read(address);
+   }
+
+   program_image::instruction read_decoded(const std::uint32_t address) const
+   {
+      return image->read_decoded(address);
    }
 
    const char* subroutine_name(const std::uint8_t address) const
    {
-      if (address == RESET_vect) return "RESET_vect";
-      else if (address == PCINT0_vect) return "PCINT0_vect";
-      else if (address >= ISR_PCINT0 && address < main) return "ISR (PCINT0_vect)";
-      else if (address >= main && address < led_toggle) return "main";
-      else if (address >= led_toggle && address < led_on) return "led_toggle";
-      else if (address >= led_on && address < led_off) return "led_on";
-      else if (address >= led_off && address < setup) return "led_off";
-      else if (address >= setup && address < button_is_pressed) return "setup";
-      else if (address >= button_is_pressed && address < end) return "button_is_pressed";
-      else return "Unknown";
+      return image->subroutine_name(address);
    }
 };
 
@@ -0,0 +1,323 @@
+#ifndef RECOMPILER_HPP_
+#define RECOMPILER_HPP_
+
+#include "program_image.hpp"
+#include "interrupt_controller.hpp"
+#include "cpu.hpp"
+
+/* Ahead-of-time recompiler, translating a program image into a C++ header
+   with one run function for the image. Every basic block becomes straight
+   line code over the core state of a control unit, ending with a direct
+   goto or with a jump back to a switch on the program counter. Interrupts
+   are checked and the instruction budget is tested at block boundaries, and
+   every instruction that enables interrupts or writes an interrupt register
+   ends its block. A run started after PINB changed executes its first
+   instruction in the interpreter, which samples the pin change after the
+   same instruction as an interpreted run. Instructions without a native
+   translation, and program counters not at the start of a block, are
+   executed by the interpreter as well. */
+struct cpu::recompiler
+{
+   static constexpr auto NUM_REGISTERS = 32;
+
+   const program_image& image;
+   std::vector<bool> leaders;
+
+   recompiler(const program_image& image)
+      : image{image}
+      , leaders(image.address_width() + 1, false)
+   {
+      find_leaders();
+      return;
+   }
+
+   static bool is_interrupt_register(const std::size_t address)
+   {
+      return address == PINB || address == PCICR || address == PCMSK0;
+   }
+
+   static bool writes_interrupt_register(const program_image::instruction& instruction)
+   {
+      if (instruction.op_code == OUT) return is_interrupt_register(instruction.op1);
+      else if (instruction.op_code == STS) return is_interrupt_register(instruction.op1) || is_interrupt_register(instruction.op1 + 1);
+      else return false;
+   }
+
+   static bool ends_block(const program_image::instruction& instruction)
+   {
+      if (instruction.op_code == JMP || instruction.op_code == CALL || instruction.op_code == RET) return true;
+      else if (instruction.op_code >= BREQ && instruction.op_code <= BRLE) return true;
+      else if (instruction.op_code == SEI) return true;
+      else return writes_interrupt_register(instruction);
+   }
+
+   static bool has_translation(const program_image::instruction& instruction)
+   {
+      if (instruction.op_code == STS) return instruction.op2 + 1 < NUM_REGISTERS;
+      else if (instruction.op_code == LDS) return instruction.op1 + 1 < NUM_REGISTERS;
+      else if (instruction.op_code >= ADDI && instruction.op_code <= SUB) return false;
+      else if (instruction.op_code == RETI) return false;
+      else return instruction.op_code <= RETI;
+   }
+
+   void find_leaders(void)
+   {
+      leaders[program_memory::RESET_vect] = true;
+
+      for (const auto i : interrupt_controller::vectors)
+      {
+         if (i != interrupt_controller::NO_VECTOR && i < leaders.size()) leaders[i] = true;
+      }
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         const auto instruction = image.read_decoded(static_cast<std::uint32_t>(i));
+         const auto is_branch = instruction.op_code == JMP || instruction.op_code == CALL ||
+                                (instruction.op_code >= BREQ && instruction.op_code <= BRLE);
+
+         if (is_branch && instruction.op1 < leaders.size()) leaders[instruction.op1] = true;
+         if (ends_block(instruction) || !has_translation(instruction)) leaders[i + 1] = true;
+      }
+      return;
+   }
+
+   static std::string hex(const unsigned value)
+   {
+      std::stringstream stream;
+      stream << "0x" << std::uppercase << std::hex << std::setw(2) << std::setfill('0') << value;
+      return stream.str();
+   }
+
+   static std::string label(const std::size_t address)
+   {
+      return "block_" + hex(static_cast<unsigned>(address));
+   }
+
+   static std::string alu_code(const program_image::instruction& instruction)
+   {
+      const auto a = "core.reg[" + hex(instruction.op1) + "]";
+      std::string b = hex(instruction.op2);
+      std::string operation = " | ";
+
+      if (instruction.op_code == OR || instruction.op_code == AND || instruction.op_code == XOR)
+      {
+         b = "core.reg[" + hex(instruction.op2) + "]";
+      }
+
+      if (instruction.op_code == ANDI || instruction.op_code == AND) operation = " & ";
+      else if (instruction.op_code == XORI || instruction.op_code == XOR) operation = " ^ ";
+
+      if (instruction.op_code == INC || instruction.op_code == DEC)
+      {
+         b = "0x00";
+         operation = instruction.op_code == INC ? " + 1" : " - 1";
+      }
+
+      const auto result = instruction.op_code == INC || instruction.op_code == DEC ? "a" + operation : "a" + operation + "b";
+
+      return "      {\n"
+             "         const std::uint8_t a = " + a + ";\n"
+             "         const std::uint8_t b = " + b + ";\n"
+             "         const std::uint16_t result = " + result + ";\n"
+             "         core.sr |= control_unit_type::get_status_bits(result, a, b);\n"
+             "         " + a + " = static_cast<std::uint8_t>(result);\n"
+             "      }\n";
+   }
+
+   static std::string branch_condition(const std::uint8_t op_code)
+   {
+      if (op_code == BREQ) return "unit.equal()";
+      else if (op_code == BRNE) return "!unit.equal()";
+      else if (op_code == BRGE) return "unit.greater() || unit.equal()";
+      else if (op_code == BRGT) return "unit.greater()";
+      else if (op_code == BRLE) return "unit.lower() || unit.equal()";
+      else return "unit.lower()";
+   }
+
+   static std::string instruction_code(const program_image::instruction& instruction,
+                                       const std::size_t address)
+   {
+      const auto op1 = hex(instruction.op1);
+      const auto op2 = hex(instruction.op2);
+      const auto next = hex(static_cast<unsigned>(address + 1));
+
+      if (instruction.op_code == LDI) return "      core.reg[" + op1 + "] = " + op2 + ";\n";
+      else if (instruction.op_code == MOV) return "      core.reg[" + op1 + "] = core.reg[" + op2 + "];\n";
+      else if (instruction.op_code == OUT) return "      unit.write_data(" + op1 + ", core.reg[" + op2 + "]);\n";
+      else if (instruction.op_code == IN) return "      core.reg[" + op1 + "] = unit.read_data(" + op2 + ");\n";
+      else if (instruction.op_code == STS)
+      {
+         return "      unit.write_data(" + op1 + ", core.reg[" + op2 + "]);\n"
+                "      unit.write_data(" + hex(instruction.op1 + 1) + ", core.reg[" + hex(instruction.op2 + 1) + "]);\n";
+      }
+      else if (instruction.op_code == LDS)
+      {
+         return "      core.reg[" + op1 + "] = unit.read_data(" + op2 + ");\n"
+                "      core.reg[" + hex(instruction.op1 + 1) + "] = unit.read_data(" + hex(instruction.op2 + 1) + ");\n";
+      }
+      else if (instruction.op_code >= ORI && instruction.op_code <= DEC && instruction.op_code != CLR) return alu_code(instruction);
+      else if (instruction.op_code == CLR) return "      core.reg[" + op1 + "] = 0x00;\n";
+      else if (instruction.op_code == CPI) return "      unit.compare(core.reg[" + op1 + "], " + op2 + ");\n";
+      else if (instruction.op_code == CP) return "      unit.compare(core.reg[" + op1 + "], core.reg[" + op2 + "]);\n";
+      else if (instruction.op_code == JMP) return "      core.pc = " + op1 + ";\n";
+      else if (instruction.op_code >= BREQ && instruction.op_code <= BRLE)
+      {
+         return "      if (" + branch_condition(instruction.op_code) + ")\n"
+                "      {\n"
+                "         core.pc = " + op1 + ";\n"
+                "         core.cycles += " + std::to_string(cycle_cost(instruction.op_code, true)) + ";\n"
+                "      }\n"
+                "      else\n"
+                "      {\n"
+                "         core.pc = " + next + ";\n"
+                "         core.cycles += " + std::to_string(cycle_cost(instruction.op_code, false)) + ";\n"
+                "      }\n";
+      }
+      else if (instruction.op_code == CALL)
+      {
+         return "      unit.stack().push(" + next + ");\n"
+                "      core.pc = " + op1 + ";\n";
+      }
+      else if (instruction.op_code == RET) return "      unit.stack().pop(core.pc);\n";
+      else if (instruction.op_code == PUSH) return "      unit.stack().push(core.reg[" + op1 + "]);\n";
+      else if (instruction.op_code == POP) return "      unit.stack().pop(core.reg[" + op1 + "]);\n";
+      else if (instruction.op_code == SEI) return "      set(core.sr, control_unit_type::I);\n";
+      else if (instruction.op_code == CLI) return "      clr(core.sr, control_unit_type::I);\n";
+      else return "";
+   }
+
+   void generate_block(const std::size_t start, std::ostream& ostream) const
+   {
+      std::size_t num_instructions = 0;
+      std::uint64_t num_cycles = 0;
+      auto address = start;
+
+      ostream << "   " << label(start) << ": /* " << image.subroutine_name(static_cast<std::uint8_t>(start)) << " */\n";
+
+      while (address < image.address_width())
+      {
+         const auto instruction = image.read_decoded(static_cast<std::uint32_t>(address));
+
+         if (!has_translation(instruction))
+         {
+            if (num_instructions > 0)
+            {
+               ostream << "      core.cycles += " << num_cycles << ";\n";
+               ostream << "      core.num_instructions += " << num_instructions << ";\n";
+            }
+
+            ostream << "      /* " << instruction_name(instruction.op_code) << " */\n";
+            ostream << "      core.pc = " << hex(static_cast<unsigned>(address)) << ";\n";
+            ostream << "      unit.step();\n";
+            ostream << "      goto boundary;\n";
+            return;
+         }
+
+         ostream << "      /* " << instruction_name(instruction.op_code) << " " << hex(instruction.op1)
+                 << ", " << hex(instruction.op2) << " */\n";
+         ostream << instruction_code(instruction, address);
+
+         const auto is_branch = instruction.op_code >= BREQ && instruction.op_code <= BRLE;
+         if (!is_branch) num_cycles += cycle_cost(instruction.op_code);
+         num_instructions++;
+
+         if (ends_block(instruction))
+         {
+            if (instruction.op_code == SEI || writes_interrupt_register(instruction))
+            {
+               ostream << "      core.pc = " << hex(static_cast<unsigned>(address + 1)) << ";\n";
+            }
+
+            ostream << "      core.cycles += " << num_cycles << ";\n";
+            ostream << "      core.num_instructions += " << num_instructions << ";\n";
+            ostream << "      core.mar = " << hex(static_cast<unsigned>(address)) << ";\n";
+            ostream << "      core.ir = " << hex(image.read(static_cast<std::uint32_t>(address))) << ";\n";
+            ostream << "      core.op_code = " << hex(instruction.op_code) << ";\n";
+            ostream << "      core.op1 = " << hex(instruction.op1) << ";\n";
+            ostream << "      core.op2 = " << hex(instruction.op2) << ";\n";
+            ostream << "      goto boundary;\n";
+            return;
+         }
+
+         address++;
+         if (leaders[address]) break;
+      }
+
+      ostream << "      core.cycles += " << num_cycles << ";\n";
+      ostream << "      core.num_instructions += " << num_instructions << ";\n";
+
+      if (address >= image.address_width())
+      {
+         ostream << "      core.pc = " << hex(static_cast<unsigned>(address)) << ";\n";
+         ostream << "      goto boundary;\n";
+      }
+      return;
+   }
+
+   void generate(const std::string& name, std::ostream& ostream) const
+   {
+      std::string guard;
+
+      for (const auto i : name)
+      {
+         guard += static_cast<char>(std::toupper(static_cast<unsigned char>(i)));
+      }
+
+      ostream << "#ifndef " << guard << "_HPP_\n";
+      ostream << "#define " << guard << "_HPP_\n\n";
+      ostream << "#include \"cpu.hpp\"\n\n";
+      ostream << "namespace cpu\n{\n   struct " << name << ";\n}\n\n";
+      ostream << "/* Generated by cpu::recompiler from a program image of "
+              << image.address_width() << " instructions, do not edit. */\n";
+      ostream << "struct cpu::" << name << "\n{\n";
+      ostream << "   static constexpr std::uint64_t IMAGE_HASH = 0x" << std::hex << std::uppercase
+              << image.hash() << std::dec << std::nouppercase << ";\n\n";
+      ostream << "   template<class control_unit_type>\n";
+      ostream << "   static void run(control_unit_type& unit, const std::uint64_t num_instructions)\n";
+      ostream << "   {\n";
+      ostream << "      auto& core = unit.core;\n";
+      ostream << "      const auto end = core.num_instructions + num_instructions;\n";
+      ostream << "      if (core.current_state != state::fetch || unit.data_mem().read(PINB) != core.last_input)\n";
+      ostream << "      {\n";
+      ostream << "         unit.step();\n";
+      ostream << "         goto boundary;\n";
+      ostream << "      }\n";
+      ostream << "      goto dispatch;\n\n";
+      ostream << "   boundary:\n";
+      ostream << "      unit.monitor_interrupts();\n";
+      ostream << "      if (core.num_instructions >= end) return;\n\n";
+      ostream << "   dispatch:\n";
+      ostream << "      switch (core.pc)\n";
+      ostream << "      {\n";
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         if (leaders[i]) ostream << "         case " << hex(static_cast<unsigned>(i)) << ": goto " << label(i) << ";\n";
+      }
+
+      ostream << "         default: unit.step(); goto boundary;\n";
+      ostream << "      }\n";
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         if (!leaders[i]) continue;
+         ostream << "\n";
+         generate_block(i, ostream);
+      }
+
+      ostream << "   }\n";
+      ostream << "};\n\n";
+      ostream << "#endif /* " << guard << "_HPP_ */";
+      return;
+   }
+
+   int save(const std::string& filename, const std::string& name) const
+   {
+      std::ofstream file(filename);
+      if (!file) return 1;
+      generate(name, file);
+      return file ? 0 : 1;
+   }
+};
+
+#endif /* RECOMPILER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef SCHEDULER_HPP_
+#define SCHEDULER_HPP_
+
+#include "cpu.hpp"
+
+/* Coroutine returned by the run loop of a simulated CPU. The coroutine is
+   started lazily by the scheduler it is spawned on, which also owns it. */
+struct cpu::task
+{
+   struct promise_type
+   {
+      task get_return_object(void)
+      {
+         return task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+      }
+
+      std::suspend_always initial_suspend(void) noexcept { return {}; }
+      std::suspend_always final_suspend(void) noexcept { return {}; }
+      void return_void(void) { }
+      void unhandled_exception(void) { std::terminate(); }
+   };
+
+   std::coroutine_handle<promise_type> handle;
+
+   explicit task(const std::coroutine_handle<promise_type> handle)
+      : handle{handle} { }
+
+   task(task&& source) noexcept
+      : handle{std::exchange(source.handle, nullptr)} { }
+
+   task(const task&) = delete;
+   task& operator=(const task&) = delete;
+   task& operator=(task&&) = delete;
+
+   ~task(void)
+   {
+      if (handle) handle.destroy();
+      return;
+   }
+};
+
+/* Single threaded scheduler, run one per core. Runnable coroutines are kept
+   in a FIFO ready queue, sleeping ones in a timer wheel indexed by the
+   simulated cycle they wake up at. */
+struct cpu::scheduler
+{
+   static constexpr std::size_t WHEEL_SIZE = 1024;
+   static constexpr std::uint64_t TICK = 256;
+
+   struct timer
+   {
+      std::uint64_t wake_time = 0;
+      std::coroutine_handle<> handle;
+   };
+
+   struct yield_awaiter
+   {
+      scheduler& owner;
+
+      bool await_ready(void) const noexcept { return false; }
+      void await_suspend(const std::coroutine_handle<> handle) { owner.ready.push_back(handle); }
+      void await_resume(void) const noexcept { }
+   };
+
+   struct sleep_awaiter
+   {
+      scheduler& owner;
+      std::uint64_t wake_time = 0;
+
+      bool await_ready(void) const noexcept { return wake_time / TICK <= owner.now / TICK; }
+      void await_suspend(const std::coroutine_handle<> handle) { owner.add_timer(wake_time, handle); }
+      void await_resume(void) const noexcept { }
+   };
+
+   std::vector<task> tasks;
+   std::deque<std::coroutine_handle<>> ready;
+   std::array<std::vector<timer>, WHEEL_SIZE> wheel;
+   std::size_t num_timers = 0;
+   std::uint64_t now = 0;
+   std::uint64_t num_resumes = 0;
+
+   void spawn(task&& new_task)
+   {
+      ready.push_back(new_task.handle);
+      tasks.push_back(std::move(new_task));
+      return;
+   }
+
+   yield_awaiter yield(void)
+   {
+      return { *this };
+   }
+
+   sleep_awaiter sleep_until(const std::uint64_t wake_time)
+   {
+      return { *this, wake_time };
+   }
+
+   void add_timer(const std::uint64_t wake_time,
+                  const std::coroutine_handle<> handle)
+   {
+      wheel[(wake_time / TICK) % WHEEL_SIZE].push_back({ wake_time, handle });
+      num_timers++;
+      return;
+   }
+
+   bool expire_timers(std::vector<timer>& slot)
+   {
+      const auto size = ready.size();
+
+      for (std::size_t i = 0; i < slot.size();)
+      {
+         if (slot[i].wake_time / TICK <= now / TICK)
+         {
+            ready.push_back(slot[i].handle);
+            slot[i] = slot.back();
+            slot.pop_back();
+            num_timers--;
+         }
+         else
+         {
+            i++;
+         }
+      }
+      return ready.size() > size;
+   }
+
+   void advance(void)
+   {
+      for (std::size_t i = 0; i < WHEEL_SIZE; ++i)
+      {
+         now += TICK;
+         if (expire_timers(wheel[(now / TICK) % WHEEL_SIZE])) return;
+      }
+
+      auto next_wake_time = UINT64_MAX;
+
+      for (const auto& slot : wheel)
+      {
+         for (const auto& i : slot)
+         {
+            if (i.wake_time < next_wake_time) next_wake_time = i.wake_time;
+         }
+      }
+
+      now = next_wake_time;
+      expire_timers(wheel[(now / TICK) % WHEEL_SIZE]);
+      return;
+   }
+
+   void run(void)
+   {
+      while (!ready.empty() || num_timers > 0)
+      {
+         while (!ready.empty())
+         {
+            const auto handle = ready.front();
+            ready.pop_front();
+            handle.resume();
+            num_resumes++;
+         }
+
+         if (num_timers > 0) advance();
+      }
+      return;
+   }
+};
+
+#endif /* SCHEDULER_HPP_ */
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef SEQLOCK_HPP_
+#define SEQLOCK_HPP_
+
+#include "cpu.hpp"
+
+/* Sequence lock for one writer and any number of readers. The writer never
+   waits, readers retry until they have copied a consistent value. The value
+   is stored as atomic words, so the structure can be placed in memory
+   shared between processes. */
+template<class T>
+struct cpu::seqlock
+{
+   static_assert(std::is_trivially_copyable_v<T>, "seqlock requires a trivially copyable type");
+   static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "seqlock requires lock-free 64-bit atomics");
+
+   static constexpr std::size_t NUM_WORDS = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+   std::atomic<std::uint64_t> sequence{0};
+   std::array<std::atomic<std::uint64_t>, NUM_WORDS> words{};
+
+   void store(const T& value)
+   {
+      std::array<std::uint64_t, NUM_WORDS> buffer{};
+      std::memcpy(buffer.data(), &value, sizeof(T));
+
+      const auto current_sequence = sequence.load(std::memory_order_relaxed);
+      sequence.store(current_sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (std::size_t i = 0; i < NUM_WORDS; ++i)
+      {
+         words[i].store(buffer[i], std::memory_order_relaxed);
+      }
+
+      sequence.store(current_sequence + 2, std::memory_order_release);
+      return;
+   }
+
+   bool try_load(T& value) const
+   {
+      std::array<std::uint64_t, NUM_WORDS> buffer{};
+      const auto start_sequence = sequence.load(std::memory_order_acquire);
+      if (start_sequence & 1) return false;
+
+      for (std::size_t i = 0; i < NUM_WORDS; ++i)
+      {
+         buffer[i] = words[i].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) != start_sequence) return false;
+
+      std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+      return true;
+   }
+
+   T load(void) const
+   {
+      T value{};
+
+      while (!try_load(value))
+      {
+         std::this_thread::yield();
+      }
+      return value;
+   }
+};
+
+#endif /* SEQLOCK_HPP_ */
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+#include "seqlock.hpp"
+#include "cpu.hpp"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Compact copy of the CPU state, published by the simulation thread
+   through a seqlock and read by monitors without stopping the CPU. */
+struct cpu::state_snapshot
+{
+   std::uint64_t num_instructions = 0;
+   std::uint64_t num_interrupts = 0;
+   std::uint64_t cycles = 0;
+
+   std::uint8_t pc = 0x00;
+   std::uint8_t sr = 0x00;
+   std::uint8_t r16 = 0x00;
+   std::uint8_t r24 = 0x00;
+
+   std::uint8_t ddrb = 0x00;
+   std::uint8_t portb = 0x00;
+   std::uint8_t pinb = 0x00;
+
+   char subroutine[25]{};
+
+   void write_metrics(std::ostream& ostream = std::cout) const
+   {
+      ostream << "# TYPE cpu_instructions_total counter\n";
+      ostream << "cpu_instructions_total " << num_instructions << "\n";
+      ostream << "# TYPE cpu_interrupts_total counter\n";
+      ostream << "cpu_interrupts_total " << num_interrupts << "\n";
+      ostream << "# TYPE cpu_cycles_total counter\n";
+      ostream << "cpu_cycles_total " << cycles << "\n";
+      ostream << "# TYPE cpu_register gauge\n";
+      ostream << "cpu_register{name=\"pc\"} " << static_cast<int>(pc) << "\n";
+      ostream << "cpu_register{name=\"sr\"} " << static_cast<int>(sr) << "\n";
+      ostream << "cpu_register{name=\"r16\"} " << static_cast<int>(r16) << "\n";
+      ostream << "cpu_register{name=\"r24\"} " << static_cast<int>(r24) << "\n";
+      ostream << "cpu_register{name=\"ddrb\"} " << static_cast<int>(ddrb) << "\n";
+      ostream << "cpu_register{name=\"portb\"} " << static_cast<int>(portb) << "\n";
+      ostream << "cpu_register{name=\"pinb\"} " << static_cast<int>(pinb) << "\n";
+      ostream << "# TYPE cpu_subroutine gauge\n";
+      ostream << "cpu_subroutine{name=\"" << subroutine << "\"} 1\n\n";
+      return;
+   }
+};
+
+/* Seqlock holding a state snapshot in a POSIX shared memory segment, so
+   that a separate process can monitor a running CPU. */
+struct cpu::shared_snapshot
+{
+   seqlock<state_snapshot>* lock = nullptr;
+   std::string name;
+   bool owner = false;
+
+   shared_snapshot(const std::string& name, const bool create)
+      : name{name}
+      , owner{create}
+   {
+#ifdef __unix__
+      const auto fd = shm_open(name.c_str(), create ? O_CREAT | O_RDWR : O_RDONLY, 0644);
+      if (fd < 0) return;
+
+      if (create && ftruncate(fd, sizeof(seqlock<state_snapshot>)) != 0)
+      {
+         close(fd);
+         return;
+      }
+
+      const auto protection = create ? PROT_READ | PROT_WRITE : PROT_READ;
+      const auto address = mmap(nullptr, sizeof(seqlock<state_snapshot>), protection, MAP_SHARED, fd, 0);
+      close(fd);
+      if (address == MAP_FAILED) return;
+
+      lock = create ? new (address) seqlock<state_snapshot>{} : static_cast<seqlock<state_snapshot>*>(address);
+#endif
+      return;
+   }
+
+   ~shared_snapshot(void)
+   {
+#ifdef __unix__
+      if (lock) munmap(lock, sizeof(seqlock<state_snapshot>));
+      if (lock && owner) shm_unlink(name.c_str());
+#endif
+      return;
+   }
+
+   shared_snapshot(const shared_snapshot&) = delete;
+   shared_snapshot& operator=(const shared_snapshot&) = delete;
+
+   bool is_open(void) const
+   {
+      return lock != nullptr;
+   }
+
+   void monitor(const std::chrono::milliseconds interval,
+                std::ostream& ostream = std::cout) const
+   {
+      while (is_open())
+      {
+         lock->load().write_metrics(ostream);
+         ostream.flush();
+         std::this_thread::sleep_for(interval);
+      }
+      return;
+   }
+};
+
+#endif /* SNAPSHOT_HPP_ */
\ No newline at end of file
@@ -0,0 +1,290 @@
+#ifndef SPECIALIZED_ENGINE_HPP_
+#define SPECIALIZED_ENGINE_HPP_
+
+#include "recompiler.hpp"
+#include "profile.hpp"
+#include "cpu.hpp"
+
+/* Execution engine specialized for a program image from its profile. Each
+   instruction is bound to the handler of its opcode when the engine is
+   built, so no opcode dispatch is left at run time. Hot adjacent pairs of
+   instructions from a fixed set of candidates are fused into one handler,
+   and the basic blocks are laid out in the slot table hottest first, each
+   followed by its most likely successor according to the branch ratios.
+   Program counters without a slot, and the first instruction of a run
+   started after PINB changed, are executed by the interpreter, so that pin
+   changes are sampled after the same instruction as in the interpreter. */
+template<class control_unit_type>
+struct cpu::specialized_engine
+{
+   struct operand
+   {
+      std::uint32_t ir = 0;
+      std::uint8_t address = 0x00;
+      std::uint8_t op1 = 0x00;
+      std::uint8_t op2 = 0x00;
+   };
+
+   struct slot;
+   using handler = void (*)(control_unit_type&, const slot&);
+
+   struct slot
+   {
+      handler execute = nullptr;
+      operand first;
+      operand second;
+   };
+
+   struct fusion
+   {
+      std::uint8_t first = NOP;
+      std::uint8_t second = NOP;
+   };
+
+   static constexpr std::uint16_t NO_SLOT = 0xFFFF;
+   static constexpr std::uint8_t MAX_OP_CODE = RETI;
+
+   static constexpr std::array<fusion, 15> FUSIONS
+   {{
+      { CPI, BREQ }, { CPI, BRNE }, { CPI, BRGE }, { CPI, BRGT }, { CPI, BRLE }, { CPI, BRLT },
+      { CP, BREQ }, { CP, BRNE }, { LDS, CPI }, { IN, ANDI }, { IN, ORI },
+      { ANDI, OUT }, { ORI, OUT }, { LDI, OUT }, { LDI, STS }
+   }};
+
+   std::vector<slot> slots;
+   std::array<std::uint16_t, profile::NUM_ADDRESSES> slot_index{};
+   std::size_t num_fused = 0;
+   std::size_t num_blocks = 0;
+
+   specialized_engine(const program_image& image,
+                      const profile& training_profile,
+                      const double min_fusion_share = 0.0001)
+   {
+      slot_index.fill(NO_SLOT);
+      const recompiler blocks{image};
+      const auto min_fusion_count = static_cast<std::uint64_t>(min_fusion_share * training_profile.num_instructions);
+
+      for (const auto i : layout(image, blocks.leaders, training_profile))
+      {
+         for (auto address = i; address < image.address_width(); ++address)
+         {
+            const auto instruction = image.read_decoded(static_cast<std::uint32_t>(address));
+            if (instruction.op_code > MAX_OP_CODE || (address != i && blocks.leaders[address])) break;
+
+            slot new_slot;
+            new_slot.execute = single_handler(instruction.op_code);
+            new_slot.first = make_operand(image, address);
+            slot_index[address] = static_cast<std::uint16_t>(slots.size());
+
+            const auto next = image.read_decoded(static_cast<std::uint32_t>(address + 1));
+            const auto fused = fused_handler(instruction.op_code, next.op_code);
+
+            if (fused && address + 1 < image.address_width() && !blocks.leaders[address + 1] &&
+                training_profile.address_counts[address] > 0 &&
+                training_profile.address_counts[address] >= min_fusion_count)
+            {
+               new_slot.execute = fused;
+               new_slot.second = make_operand(image, ++address);
+               num_fused++;
+            }
+
+            slots.push_back(new_slot);
+         }
+         num_blocks++;
+      }
+      return;
+   }
+
+   static operand make_operand(const program_image& image, const std::size_t address)
+   {
+      const auto instruction = image.read_decoded(static_cast<std::uint32_t>(address));
+      return { image.read(static_cast<std::uint32_t>(address)), static_cast<std::uint8_t>(address), instruction.op1, instruction.op2 };
+   }
+
+   static std::vector<std::size_t> layout(const program_image& image,
+                                          const std::vector<bool>& leaders,
+                                          const profile& training_profile)
+   {
+      std::vector<std::size_t> starts;
+      std::vector<std::size_t> order;
+      std::vector<bool> placed(leaders.size(), false);
+
+      for (std::size_t i = 0; i < image.address_width(); ++i)
+      {
+         if (leaders[i]) starts.push_back(i);
+      }
+
+      std::stable_sort(starts.begin(), starts.end(), [&training_profile](const std::size_t a, const std::size_t b)
+      {
+         return training_profile.address_counts[a] > training_profile.address_counts[b];
+      });
+
+      for (const auto i : starts)
+      {
+         for (auto block = i; block < image.address_width() && !placed[block];)
+         {
+            placed[block] = true;
+            order.push_back(block);
+
+            auto end = block + 1;
+            while (end < image.address_width() && !leaders[end]) end++;
+
+            const auto last = image.read_decoded(static_cast<std::uint32_t>(end - 1));
+            const auto is_branch = last.op_code >= BREQ && last.op_code <= BRLE;
+            const auto taken = training_profile.taken_ratio(static_cast<std::uint8_t>(end - 1)) >= 0.5;
+
+            if (last.op_code == JMP || last.op_code == CALL || (is_branch && taken)) block = last.op1;
+            else if (last.op_code == RET || last.op_code == RETI) break;
+            else block = end;
+
+            if (block >= leaders.size() || !leaders[block]) break;
+         }
+      }
+      return order;
+   }
+
+   template<std::uint8_t op_code>
+   static bool operation(control_unit_type& unit, const std::uint8_t op1, const std::uint8_t op2)
+   {
+      auto& core = unit.core;
+
+      if constexpr (op_code == LDI) core.reg[op1] = op2;
+      else if constexpr (op_code == MOV) core.reg[op1] = core.reg[op2];
+      else if constexpr (op_code == OUT) unit.write_data(op1, core.reg[op2]);
+      else if constexpr (op_code == IN) core.reg[op1] = unit.read_data(op2);
+      else if constexpr (op_code == STS)
+      {
+         unit.write_data(static_cast<std::size_t>(op1), core.reg[op2]);
+         if (op2 < control_unit_type::NUM_REGISTERS) unit.write_data(static_cast<std::size_t>(op1) + 1, core.reg[static_cast<std::uint8_t>(op2 + 1)]);
+      }
+      else if constexpr (op_code == LDS)
+      {
+         core.reg[op1] = unit.read_data(op2);
+         if (op1 < control_unit_type::NUM_REGISTERS) core.reg[static_cast<std::uint8_t>(op1 + 1)] = unit.read_data(static_cast<std::size_t>(op2 + 1));
+      }
+      else if constexpr (op_code == ORI || op_code == ANDI || op_code == XORI) core.reg[op1] = unit.alu(core.reg[op1], op2);
+      else if constexpr (op_code == OR || op_code == AND || op_code == XOR) core.reg[op1] = unit.alu(core.reg[op1], core.reg[op2]);
+      else if constexpr (op_code == CLR) core.reg[op1] = 0x00;
+      else if constexpr (op_code == INC || op_code == DEC) core.reg[op1] = unit.alu(core.reg[op1]);
+      else if constexpr (op_code == CPI) unit.compare(core.reg[op1], op2);
+      else if constexpr (op_code == CP) unit.compare(core.reg[op1], core.reg[op2]);
+      else if constexpr (op_code == JMP) core.pc = op1;
+      else if constexpr (op_code == BREQ) return unit.branch(unit.equal());
+      else if constexpr (op_code == BRNE) return unit.branch(!unit.equal());
+      else if constexpr (op_code == BRGE) return unit.branch(unit.greater() || unit.equal());
+      else if constexpr (op_code == BRGT) return unit.branch(unit.greater());
+      else if constexpr (op_code == BRLE) return unit.branch(unit.lower() || unit.equal());
+      else if constexpr (op_code == BRLT) return unit.branch(unit.lower());
+      else if constexpr (op_code == CALL)
+      {
+         unit.stack().push(core.pc);
+         core.pc = op1;
+      }
+      else if constexpr (op_code == RET) unit.stack().pop(core.pc);
+      else if constexpr (op_code == PUSH) unit.stack().push(core.reg[op1]);
+      else if constexpr (op_code == POP) unit.stack().pop(core.reg[op1]);
+      else if constexpr (op_code == SEI) set(core.sr, control_unit_type::I);
+      else if constexpr (op_code == CLI) clr(core.sr, control_unit_type::I);
+      else if constexpr (op_code == RETI) unit.return_from_interrupt();
+      return false;
+   }
+
+   template<std::uint8_t op_code>
+   static void execute_one(control_unit_type& unit, const operand& current)
+   {
+      auto& core = unit.core;
+      core.ir = current.ir;
+      core.mar = current.address;
+      core.pc = current.address + 1;
+      core.op_code = op_code;
+      core.op1 = current.op1;
+      core.op2 = current.op2;
+
+      const auto taken = operation<op_code>(unit, current.op1, current.op2);
+      core.cycles += cycle_cost(op_code, taken);
+      core.num_instructions++;
+      return;
+   }
+
+   template<std::uint8_t op_code>
+   static void execute_single(control_unit_type& unit, const slot& slot)
+   {
+      execute_one<op_code>(unit, slot.first);
+      return;
+   }
+
+   template<std::uint8_t first, std::uint8_t second>
+   static void execute_fused(control_unit_type& unit, const slot& slot)
+   {
+      execute_one<first>(unit, slot.first);
+      execute_one<second>(unit, slot.second);
+      return;
+   }
+
+   template<std::size_t... op_codes>
+   static handler single_handler(const std::uint8_t op_code, std::index_sequence<op_codes...>)
+   {
+      static constexpr std::array<handler, sizeof...(op_codes)> handlers{ &execute_single<static_cast<std::uint8_t>(op_codes)>... };
+      return handlers[op_code];
+   }
+
+   static handler single_handler(const std::uint8_t op_code)
+   {
+      return single_handler(op_code, std::make_index_sequence<MAX_OP_CODE + 1>{});
+   }
+
+   template<std::size_t... indices>
+   static handler fused_handler(const std::uint8_t first, const std::uint8_t second, std::index_sequence<indices...>)
+   {
+      static constexpr std::array<handler, sizeof...(indices)> handlers{ &execute_fused<FUSIONS[indices].first, FUSIONS[indices].second>... };
+
+      for (std::size_t i = 0; i < FUSIONS.size(); ++i)
+      {
+         if (FUSIONS[i].first == first && FUSIONS[i].second == second) return handlers[i];
+      }
+      return nullptr;
+   }
+
+   static handler fused_handler(const std::uint8_t first, const std::uint8_t second)
+   {
+      return fused_handler(first, second, std::make_index_sequence<FUSIONS.size()>{});
+   }
+
+   void run(control_unit_type& unit, const std::uint64_t num_instructions) const
+   {
+      auto& core = unit.core;
+      const auto end = core.num_instructions + num_instructions;
+
+      if (core.current_state != state::fetch || unit.data_mem().read(PINB) != core.last_input)
+      {
+         unit.step();
+      }
+
+      while (core.num_instructions < end)
+      {
+         const auto index = slot_index[core.pc];
+
+         if (index == NO_SLOT)
+         {
+            unit.step();
+         }
+         else
+         {
+            const auto& current = slots[index];
+            current.execute(unit, current);
+            unit.monitor_interrupts();
+         }
+      }
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      ostream << "Specialized slots:\t\t\t\t" << slots.size() << "\n";
+      ostream << "Fused instruction pairs:\t\t\t" << num_fused << "\n";
+      ostream << "Basic blocks laid out:\t\t\t\t" << num_blocks << "\n";
+      return;
+   }
+};
+
+#endif /* SPECIALIZED_ENGINE_HPP_ */
\ No newline at end of file
@@ -3,43 +3,41 @@
 
 #include "cpu.hpp"
 
+/* View of the stack segment in the memory block of a control unit. The
+   stack pointer and the empty flag live in the core state of the control
+   unit, since they are updated on every push and pop. */
 template<class T>
 struct cpu::stack
 {
-   std::vector<T> data;
-   std::size_t sp = 0;
-   bool stack_empty = true;
+   T* data = nullptr;
+   std::size_t size = 0;
+   std::uint32_t& sp;
+   bool& stack_empty;
+
+   stack(T* data, 
+         const std::size_t address_width,
+         std::uint32_t& sp,
+         bool& stack_empty)
+      : data{data}
+      , size{address_width}
+      , sp{sp}
+      , stack_empty{stack_empty} { }
 
    void reset(void)
    {
-      for (auto& i : data)
+      for (std::size_t i = 0; i < size; ++i)
       {
-         i = 0x00;
+         data[i] = 0x00;
       }
 
-      sp = address_width() - 1;
+      sp = static_cast<std::uint32_t>(address_width() - 1);
       stack_empty = true;
       return;
    }
 
-   stack(void) { }
-
-   stack(const std::size_t address_width)
-   {
-      init(address_width);
-      return;
-   }
-
-   void init(const std::size_t address_width = 256)
-   {
-      data.resize(address_width, 0);
-      sp = address_width - 1;
-      return;
-   }
-
    std::size_t address_width(void) const
    {
-      return data.size();
+      return size;
    }
 
    int push(const T& new_element)
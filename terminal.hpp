@@ -0,0 +1,290 @@
+#ifndef TERMINAL_HPP_
+#define TERMINAL_HPP_
+
+#include "control_unit.hpp"
+#include "command_queue.hpp"
+#include "snapshot.hpp"
+#include "cpu.hpp"
+
+/* Menu, real time mode and display of a control unit in the terminal,
+   kept apart from the control unit so that its hot state stays small. */
+template<class debug_policy, class heatmap_policy>
+struct cpu::terminal
+{
+   control_unit<debug_policy, heatmap_policy>& unit;
+   seqlock<state_snapshot>* publisher = nullptr;
+
+   terminal(control_unit<debug_policy, heatmap_policy>& unit)
+      : unit{unit} { }
+
+   void publish(void)
+   {
+      if (publisher) publisher->store(unit.snapshot());
+      return;
+   }
+
+   void print(std::ostream& ostream = std::cout) const
+   {
+      ostream << "--------------------------------------------------------------------------------\n";
+      ostream << "Subroutine:\t\t\t\t\t" << unit.prog_mem.subroutine_name(unit.core.mar) << "\n";
+      ostream << "Current instruction:\t\t\t\t" << cpu::instruction_name(unit.core.op_code) << "\n";
+      ostream << "Current state:\t\t\t\t\t" << cpu::state_name(unit.core.current_state) << "\n\n";
+
+      ostream << "Program counter:\t\t\t\t" << static_cast<int>(unit.core.pc) << "\n";
+      ostream << "Instruction register:\t\t\t\t" << std::hex << static_cast<int>(unit.core.ir) << "\n";
+      ostream << "Status register (INZVC):\t\t\t" << std::bitset<5>(unit.core.sr) << "\n";
+      ostream << "Pending interrupts:\t\t\t\t" << std::bitset<8>(unit.core.pending) << "\n";
+      ostream << "Cycle count:\t\t\t\t\t" << std::dec << unit.core.cycles << "\n";
+      ostream << "Elapsed time at 16 MHz:\t\t\t\t" << unit.elapsed_time() * 1e6 << " us\n";
+      ostream << "Worst case interrupt response:\t\t\t" << unit.worst_case_interrupt_cycles << " cycles\n\n";
+
+      ostream << "Content in CPU register R16:\t\t\t" << std::bitset<8>(unit.core.reg[R16]) << "\n";
+      ostream << "Content in CPU register R24:\t\t\t" << std::bitset<8>(unit.core.reg[R24]) << "\n\n";
+
+      ostream << "Content in data direction register DDRB:\t" << std::bitset<8>(unit.data_mem().read(DDRB)) << "\n";
+      ostream << "Content in data register PORTB:\t\t\t" << std::bitset<8>(unit.data_mem().read(PORTB)) << "\n";
+      ostream << "Content in pin register PINB:\t\t\t" << std::bitset<8>(unit.data_mem().read(PINB)) << "\n";
+      ostream << "--------------------------------------------------------------------------------\n\n";
+   }
+
+   static void readline(std::string& s)
+   {
+      std::getline(std::cin, s);
+      std::cout << "\n";
+      return;
+   }
+
+   template<class T = int>
+   static T get_input(void)
+   {
+      std::string s;
+      readline(s);
+      return convert<T>(s);
+   }
+
+   void print_menu(void) const
+   {
+      std::cout << "Please select an alternative:\n";
+      std::cout << "1. Execute next instruction cycle\n";
+      std::cout << "2. Execute next state\n";
+      std::cout << "3. System reset\n";
+      std::cout << "4. Enter input to the PINB register\n";
+      std::cout << "5. Run in real time mode\n\n";
+      return;
+   }
+
+   int get_selection(void) const
+   {
+      print_menu();
+
+      while (1)
+      {
+         const auto selection = get_input();
+
+         if (selection >= 1 && selection <= 5)
+         {
+            return selection;
+         }
+         else
+         {
+            std::cout << "Invalid input, try again!\n\n";
+         }
+      }
+   }
+
+   void execute_selection(void)
+   {
+      const auto selection = get_selection();
+
+      if (selection == 1)
+      {
+         std::cout << "Executing next instruction cycle!\n\n";
+         unit.run_next_instruction();
+      }
+      if (selection == 2)
+      {
+         std::cout << "Executing next state!\n\n";
+         unit.run_next_state();
+      }
+      else if (selection == 3)
+      {
+         unit.reset();
+         std::cout << "System reset!\n\n";
+      }
+      else if (selection == 4)
+      {
+         std::cout << "Enter new input for the PINB register:\n";
+         const auto input = get_input();
+         unit.data_mem().write(PINB, input);
+         std::cout << "Wrote data " << std::bitset<8>(input) << " to register PINB!\n\n";
+      }
+      else if (selection == 5)
+      {
+         std::cout << "Enter clock frequency in Hz (0 = as fast as possible):\n";
+         const auto clock_frequency = get_input<double>();
+         std::cout << "Enter display frame rate in Hz:\n";
+         const auto frame_rate = get_input<double>();
+         run_in_real_time(clock_frequency, frame_rate);
+      }
+      return;
+   }
+
+   static void print_real_time_help(void)
+   {
+      std::cout << "Real time mode commands:\n";
+      std::cout << "p <value>\tWrite <value> to the PINB register\n";
+      std::cout << "r\t\tSystem reset\n";
+      std::cout << "s\t\tPause execution\n";
+      std::cout << "c\t\tContinue execution\n";
+      std::cout << "q\t\tQuit real time mode\n\n";
+      return;
+   }
+
+   static void read_commands(command_queue<command>& commands)
+   {
+      std::string s;
+
+      while (std::getline(std::cin, s))
+      {
+         command new_command;
+
+         if (s.empty()) continue;
+         else if (s[0] == 'p') new_command = { command_type::pinb, static_cast<std::uint8_t>(convert(s.substr(1))) };
+         else if (s[0] == 'r') new_command.type = command_type::reset;
+         else if (s[0] == 's') new_command.type = command_type::pause;
+         else if (s[0] == 'c') new_command.type = command_type::resume;
+         else if (s[0] == 'q') break;
+         else
+         {
+            print_real_time_help();
+            continue;
+         }
+
+         while (!commands.push(new_command))
+         {
+            std::this_thread::yield();
+         }
+      }
+
+      while (!commands.push({ command_type::quit }))
+      {
+         std::this_thread::yield();
+      }
+      return;
+   }
+
+   void run_in_real_time(const double clock_frequency = 1000.0,
+                         const double frame_rate = 10.0)
+   {
+      using clock = std::chrono::steady_clock;
+      static constexpr std::uint64_t MAX_BATCH = 10000;
+
+      command_queue<command> commands;
+      std::thread input_thread(read_commands, std::ref(commands));
+
+      const auto frame_period = std::chrono::duration_cast<clock::duration>(
+         std::chrono::duration<double>(1.0 / (frame_rate > 0 ? frame_rate : 1.0)));
+
+      auto start_time = clock::now();
+      auto next_frame = start_time;
+      auto start_cycles = unit.core.cycles;
+      auto paused = false;
+      auto running = true;
+
+      print_real_time_help();
+
+      while (running)
+      {
+         command new_command;
+
+         while (commands.pop(new_command))
+         {
+            if (new_command.type == command_type::pinb)
+            {
+               unit.data_mem().write(PINB, new_command.value);
+            }
+            else if (new_command.type == command_type::reset)
+            {
+               unit.reset();
+               start_time = clock::now();
+               start_cycles = unit.core.cycles;
+            }
+            else if (new_command.type == command_type::pause)
+            {
+               paused = true;
+            }
+            else if (new_command.type == command_type::resume && unit.halted())
+            {
+               if constexpr (debug_policy::enabled) unit.debug.resume();
+               start_time = clock::now();
+               start_cycles = unit.core.cycles;
+            }
+            else if (new_command.type == command_type::resume && paused)
+            {
+               paused = false;
+               start_time = clock::now();
+               start_cycles = unit.core.cycles;
+            }
+            else if (new_command.type == command_type::quit)
+            {
+               running = false;
+            }
+         }
+
+         const auto now = clock::now();
+
+         if (!paused)
+         {
+            auto target = unit.core.cycles + MAX_BATCH;
+
+            if (clock_frequency > 0)
+            {
+               const std::chrono::duration<double> elapsed = now - start_time;
+               target = start_cycles + static_cast<std::uint64_t>(elapsed.count() * clock_frequency);
+
+               if (target > unit.core.cycles + MAX_BATCH)
+               {
+                  start_cycles += target - unit.core.cycles - MAX_BATCH;
+                  target = unit.core.cycles + MAX_BATCH;
+               }
+            }
+
+            while (unit.core.cycles < target && !unit.halted())
+            {
+               unit.run_next_state();
+            }
+         }
+
+         publish();
+
+         if (now >= next_frame)
+         {
+            print();
+            if (paused) std::cout << "Paused!\n\n";
+            else if (unit.halted()) std::cout << "Stopped by breakpoint or watchpoint!\n\n";
+            next_frame = now + frame_period;
+         }
+
+         if (paused || clock_frequency > 0)
+         {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         }
+      }
+
+      input_thread.join();
+      return;
+   }
+
+   void run_with_key_press(void)
+   {
+      while (1)
+      {
+         publish();
+         print();        
+         execute_selection();
+      }
+      return;
+   }
+};
+
+#endif /* TERMINAL_HPP_ */
\ No newline at end of file